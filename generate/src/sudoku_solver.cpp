@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "sudoku_solver.h"
+#include "libsat.h"
 
-// 简单的CNF解析和求解（实际项目中应该使用完整的SAT求解器）
+// 变量编号和 sudoku_generator.cpp 里的 sudokuToVar 一致: row*81 + col*9 + num
 int solveSudokuFromCNF(const char* cnf_filename, int solution[9][9]) {
     // 初始化解决方案
     for (int i = 0; i < 9; i++) {
@@ -10,17 +12,38 @@ int solveSudokuFromCNF(const char* cnf_filename, int solution[9][9]) {
             solution[i][j] = 0;
         }
     }
-    
-    // 这里应该调用完整的SAT求解器
-    // 为了演示，我们返回1表示成功
-    printf("Note: This is a placeholder solver. In real implementation, you would use your DPLL solver here.\n");
-    
-    // 模拟一个解
-    for (int i = 0; i < 9; i++) {
-        for (int j = 0; j < 9; j++) {
-            solution[i][j] = (i * 3 + j) % 9 + 1;
+
+    CNF cnf;
+    if (!init_cnf(&cnf)) return 0;
+    if (!load_cnf_from_file(&cnf, cnf_filename)) {
+        free_cnf(&cnf);
+        return 0;
+    }
+
+    SatSolver* solver = sat_solver_new(NULL);
+    if (!solver) {
+        free_cnf(&cnf);
+        return 0;
+    }
+    sat_add_cnf(solver, &cnf);
+    free_cnf(&cnf);
+
+    SatResult result = sat_solve(solver);
+    if (result == SAT) {
+        for (int row = 0; row < 9; row++) {
+            for (int col = 0; col < 9; col++) {
+                for (int num = 1; num <= 9; num++) {
+                    if (sat_model_value(solver, row * 81 + col * 9 + num) == TRUE) {
+                        solution[row][col] = num;
+                        break;
+                    }
+                }
+            }
         }
+    } else {
+        printf("Solver result: %s\n", result == UNSAT ? "UNSAT" : "UNKNOWN");
     }
-    
-    return 1;
-}
\ No newline at end of file
+
+    sat_solver_delete(solver);
+    return result == SAT;
+}
@@ -0,0 +1,65 @@
+#ifndef CLAUSE_EXCHANGE_H
+#define CLAUSE_EXCHANGE_H
+
+#include "sat_data_structures.h"
+#include <atomic>
+
+// =========== 线程间交换学习子句 ===========
+// 所有线程共用一个环形缓冲: 导出时用 fetch_add 抢一个位置写进去, 不加锁;
+// 每个线程有自己的读游标, 重启时把别人导出的子句读进来
+// 读得慢的被覆盖就直接跳过(记在 missed 里), 写的一方从来不等读的一方
+// 槽位的序号兼做版本号(seqlock): 写的时候是奇数, 写完是 2*(位置+1),
+// 读之前和读之后序号一样才算读到了完整的子句
+
+#define EXCHANGE_MAX_SIZE 8         // 能交换的最长子句
+#define EXCHANGE_CAPACITY 4096      // 槽位数, 必须是2的幂
+#define EXCHANGE_DEFERRED 1024      // 确定性模式下每个来源每轮最多攒的子句数
+
+struct ExchangeSlot {
+    std::atomic<unsigned long long> seq;
+    std::atomic<int> from;          // 导出的线程
+    std::atomic<int> size;
+    std::atomic<int> lbd;
+    std::atomic<int> lits[EXCHANGE_MAX_SIZE];
+};
+
+// 确定性模式下先攒着的子句
+typedef struct {
+    int size;
+    int lbd;
+    Literal lits[EXCHANGE_MAX_SIZE];
+} DeferredClause;
+
+class ClauseExchange {
+public:
+    ClauseExchange();
+    ~ClauseExchange();
+
+    // 确定性模式: 来源 0..sources-1 的 publish 先存进各自的缓冲(只有那个线程写),
+    // flush_deferred 再按来源编号的顺序写进环. 两次 flush 之间环不变,
+    // 读到什么只取决于 flush 了几次, 和线程怎么调度无关. 分配失败返回FALSE
+    int defer(int sources);
+    // 只能在所有来源都停下时调用
+    void flush_deferred();
+
+    // 导出一个子句, 槽位正被别的线程写时放弃并返回FALSE
+    int publish(int from, const Literal* lits, int size, int lbd);
+    // 新的读者从当前位置读起, 之前导出的不要了
+    unsigned long long start_cursor() const;
+    // 读下一个不是自己导出的子句, 读完了返回FALSE
+    // missed 加上被覆盖或者没写完而跳过的个数
+    int fetch(unsigned long long* cursor, int self, Literal* lits, int* size, int* lbd, long long* missed);
+
+private:
+    ClauseExchange(const ClauseExchange&);
+    ClauseExchange& operator=(const ClauseExchange&);
+
+    std::atomic<unsigned long long> head_;      // 下一个要写的位置
+    ExchangeSlot slots_[EXCHANGE_CAPACITY];
+
+    int sources_;                   // 0: 不攒, 直接写环
+    DeferredClause* deferred_;      // sources_ * EXCHANGE_DEFERRED 个
+    int* deferred_count_;
+};
+
+#endif // CLAUSE_EXCHANGE_H
@@ -0,0 +1,27 @@
+#ifndef CLAUSE_STORE_H
+#define CLAUSE_STORE_H
+
+#include "sat_data_structures.h"
+#include "vec.h"
+
+// =========== 共享的原始子句库 ===========
+// portfolio 里所有线程面对的是同一个公式, 原始子句只存一份:
+// 建好之后只读, 各线程的求解器用 add_shared_clause 直接引用里面的文字
+// 建库时顺便去掉重复文字和重言式, 这样大部分子句不需要再复制
+
+struct ClauseStore {
+    MemTracker mem;                     // 子句库自己的记账, 必须在Vec之前声明
+    Vec<Literal, MEM_CLAUSES> lits;     // 所有子句的文字首尾相接
+    Vec<int, MEM_CLAUSES> starts;       // 第i个子句是 lits[starts[i], starts[i+1])
+    int num_vars;
+    int has_empty;                      // 原公式里有空子句
+
+    int num_clauses() const { return starts.size() > 0 ? starts.size() - 1 : 0; }
+    const Literal* clause(int i) const { return lits.data() + starts[i]; }
+    int clause_size(int i) const { return starts[i + 1] - starts[i]; }
+};
+
+// 从CNF建库, 内存不够返回FALSE
+int build_clause_store(ClauseStore* store, const CNF* cnf);
+
+#endif // CLAUSE_STORE_H
@@ -0,0 +1,50 @@
+#ifndef CUBE_H
+#define CUBE_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+#include "clause_store.h"
+
+// =========== cube-and-conquer ===========
+// 先用lookahead把公式按变量切成很多个cube(一组假设文字), 再让一组线程
+// 各自用一个增量求解器在假设下逐个解cube. 每个线程有自己的双端队列,
+// 自己从队尾取, 闲了就从别人队头偷. 任何一个cube SAT 整个就是SAT,
+// 所有cube都UNSAT(或者在lookahead时就矛盾)才是UNSAT
+// 预算(时间/冲突等)是整个过程的: 时间从切cube之前算起, 计数是所有线程加起来的
+
+typedef struct {
+    int depth;      // 最多切几层
+    int limit;      // cube数的上限, 到了就不再往下切
+    int threads;    // 求解线程数, <= 0 时按CPU核数
+} CubeOptions;
+
+typedef struct {
+    int threads;
+    int cubes;                  // 交给求解器的cube数
+    int refuted;                // lookahead时就矛盾的分支
+    int solved;                 // 解完的cube数(SAT时其余的会被打断)
+    int steals;                 // 从别的线程偷来的cube数
+    double lookahead_seconds;
+    double conquer_seconds;
+    // 每个解完的cube的用时(秒)
+    double cube_min;
+    double cube_median;
+    double cube_max;
+    double cube_mean;
+    double efficiency;          // 负载均衡: 各线程忙的时间之和 / (线程数 * conquer墙钟时间)
+    SolverStats stats;          // 所有线程加起来, 内存是最大的那个线程的
+} CubeResult;
+
+void init_cube_options(CubeOptions* options);
+
+// 只切不解: cube首尾相接放进 lits, 第i个是 lits[starts[i], starts[i+1])
+// 公式在第0层就矛盾返回FALSE; refuted 累加lookahead时矛盾的分支数
+// 内存不够时抛 MemoryExhausted
+int split_cubes(const ClauseStore* store, const CubeOptions* options, Vec<Literal>& lits, Vec<int>& starts,
+                int* refuted);
+
+// SAT时模型写进assignment; result可以为NULL
+SatResult cube_and_conquer(const CNF* cnf, Assignment* assignment, const SolverConfig* config,
+                           const CubeOptions* options, CubeResult* result);
+
+#endif // CUBE_H
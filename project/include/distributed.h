@@ -0,0 +1,46 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+#include "cube.h"
+#include "wire.h"
+
+// =========== 多进程求解 ===========
+// 协调进程把工作切成cube(或者portfolio的各个配置), 启动若干个工作进程
+// (默认是本程序加 --worker), 通过 wire.h 的二进制协议发公式和工作, 收结果;
+// 工作进程学到的单元/二元子句经协调进程转发给其他工作进程
+// 工作进程只用标准输入输出通信, 所以 worker_command 换成
+// "ssh host sat_solver --worker" 之类就能跑在别的机器上
+
+typedef struct {
+    int workers;                // 工作进程数, <= 0 时按CPU核数
+    int cube;                   // TRUE: 按cube分工作; FALSE: 每个进程一个portfolio配置
+    CubeOptions cube_options;   // 只用 depth 和 limit
+    const char* worker_command; // NULL: 本程序 --worker; 否则交给 /bin/sh -c
+} DistributedOptions;
+
+typedef struct {
+    int workers;                // 成功握手的工作进程数
+    int work_items;             // cube数(或者portfolio配置数)
+    int refuted;                // lookahead时就矛盾的cube
+    int completed;              // 得到结果的工作数
+    int lost;                   // 中途退出的工作进程数, 它手上的工作会重新分配
+    long long clauses_forwarded;
+    long long bytes_sent;       // 协调进程这一端的流量
+    long long bytes_received;
+    SolverStats stats;          // 各工作加起来(没有内存数据)
+} DistributedResult;
+
+void init_distributed_options(DistributedOptions* options);
+
+// SAT时模型写进assignment; result可以为NULL
+SatResult distributed_solve(const CNF* cnf, Assignment* assignment, const SolverConfig* config,
+                            const DistributedOptions* options, DistributedResult* result);
+
+// 工作进程的主循环: 在 channel 上收工作直到 QUIT 或者对方关闭, 返回进程退出码
+int run_worker(WireChannel* channel);
+// 用标准输入输出当通道跑 run_worker; 标准输出之后改指向标准错误, 免得别的输出混进协议
+int run_stdio_worker(void);
+
+#endif // DISTRIBUTED_H
@@ -0,0 +1,15 @@
+#ifndef EQUIVALENCE_H
+#define EQUIVALENCE_H
+
+#include "search_state.h"
+
+// =========== 等价文字 ===========
+// 二元子句 (a b) 是蕴含图里的两条边 -a -> b, -b -> a, 图里同一个强连通分量的文字两两等价.
+// 预处理(simplifier)和搜索中的化简(search_engine)都用这一份
+
+// binaries 里每两个文字是一个二元子句. repr 按变量给出和正文字等价的代表文字:
+// 代表是类里编号最小的变量, 自己是代表时 repr[v] == v.
+// 有文字和自己的反面在同一个分量里(公式矛盾)时返回FALSE. 内存不够抛 MemoryExhausted
+int find_equivalences(int num_vars, const Vec<Literal>& binaries, Vec<Literal>& repr);
+
+#endif // EQUIVALENCE_H
@@ -5,16 +5,26 @@
 // Load CNF from file
 int load_cnf_from_file(CNF* cnf, const char* filename); 
 
+// Write CNF in DIMACS format, one clause per line
+int save_cnf_to_file(const CNF* cnf, const char* filename);
+
 // Interactive load CNF with user input
 int load_cnf_interactive(CNF* cnf, char* filename_out);
 
 // Save result to file
 void save_result(const char* filename, SatResult result, const Assignment* assignment, double elapsed_time_ms);
 
+// Read a result written by save_result; assignment is initialized with num_variables first,
+// variables missing from the model stay UNASSIGNED
+int load_result(const char* filename, int num_variables, SatResult* result, Assignment* assignment);
+
 // Verify result function
 int verify_result(const char* cnf_file, const char* res_file);
 
 // Save and print result in one step
 void save_and_print_result(const char* filename, SatResult result, const Assignment* assignment, double elapsed_time_ms);
 
+// Same as above but without the interactive verification prompt
+void save_and_print_result_batch(const char* filename, SatResult result, const Assignment* assignment, double elapsed_time_ms);
+
 #endif // FILEOF_H
\ No newline at end of file
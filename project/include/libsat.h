@@ -0,0 +1,40 @@
+#ifndef LIBSAT_H
+#define LIBSAT_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+
+// =========== libsat 求解器接口 ===========
+// 每个 SatSolver 句柄是一个完全独立的求解器, 所有状态(子句, 统计, 内存记账)都在句柄里
+// 不同线程可以同时使用不同的句柄; 同一个句柄不能并发调用, 只有 sat_interrupt 例外
+// 唯一的进程级状态是信号取消标志(见 solver_engine.h 的 request_cancel)
+
+typedef struct SatSolver SatSolver;
+
+// config 为NULL时用默认配置, 失败返回NULL
+SatSolver* sat_solver_new(const SolverConfig* config);
+void sat_solver_delete(SatSolver* solver);
+
+// 添加子句(DIMACS文字), 返回FALSE表示公式已经矛盾或者内存不够
+// 可以在两次 sat_solve 之间继续添加, 学到的子句, 变量活跃度和相位都会保留
+int sat_add_clause(SatSolver* solver, const Literal* lits, int size);
+// 把整个CNF加进去
+int sat_add_cnf(SatSolver* solver, const CNF* cnf);
+
+SatResult sat_solve(SatSolver* solver);
+// 假设 lits 全部为真来求解, 假设只对这一次调用有效
+// 常见用法是给一组子句加上激活文字 a: (-a | C), 需要时假设 a, 不要了就加单元子句 -a
+SatResult sat_solve_assuming(SatSolver* solver, const Literal* assumptions, int count);
+// 上一次 sat_solve_assuming 返回UNSAT时, 导致矛盾的那部分假设; 为空说明公式本身UNSAT
+const Literal* sat_failed_assumptions(const SatSolver* solver, int* count);
+
+// SAT之后读模型: TRUE/FALSE
+int sat_model_value(const SatSolver* solver, Variable var);
+int sat_num_variables(const SatSolver* solver);
+// 最近一次solve的统计
+const SolverStats* sat_stats(const SatSolver* solver);
+
+// 让正在进行的 sat_solve 尽快返回UNKNOWN, 可以从别的线程调用
+void sat_interrupt(SatSolver* solver);
+
+#endif // LIBSAT_H
@@ -0,0 +1,65 @@
+#ifndef MEM_TRACK_H
+#define MEM_TRACK_H
+
+#include <stddef.h>
+
+// =========== 内存记账 ===========
+// 所有求解相关的分配都经过这里, 按子系统统计字节数和分配次数
+// 每个求解器有自己的 MemTracker; 没有指定时记到当前线程的默认记账上(读cnf等)
+// 超过上限不会立刻失败, 只是标记出来, 由求解器在安全的地方处理(先删学习子句, 再返回UNKNOWN)
+
+typedef enum {
+    MEM_CLAUSES,        // 子句文字, 子句表, CNF
+    MEM_WATCHES,        // 监视表/出现表/计数
+    MEM_HEURISTIC,      // 活跃度, 堆, 权重
+    MEM_TRAIL,          // trail, 赋值, 层数, 原因
+    MEM_OTHER,          // 临时数组等
+    MEM_SUBSYSTEM_COUNT
+} MemSubsystem;
+
+typedef struct {
+    long long bytes[MEM_SUBSYSTEM_COUNT];       // 当前占用
+    long long peak_bytes[MEM_SUBSYSTEM_COUNT];  // 各子系统峰值
+    long long allocs[MEM_SUBSYSTEM_COUNT];      // 分配次数(realloc也算)
+    long long total;                            // 当前总量
+    long long peak_total;                       // 总量峰值
+    long long limit;                            // 上限, 0表示不限
+} MemTracker;
+
+void init_mem_tracker(MemTracker* tracker, long long limit);
+// 是否超过上限
+int mem_over_limit(const MemTracker* tracker);
+
+// 当前线程正在记账的对象, 以及切换(返回原来的)
+MemTracker* mem_current_tracker(void);
+MemTracker* mem_swap_tracker(MemTracker* tracker);
+
+// 分配/释放, tracker为NULL时用当前线程的; 失败返回NULL
+void* mem_alloc(MemTracker* tracker, size_t bytes, MemSubsystem sub);
+void* mem_realloc(MemTracker* tracker, void* p, size_t old_bytes, size_t new_bytes, MemSubsystem sub);
+void mem_free(MemTracker* tracker, void* p, size_t bytes, MemSubsystem sub);
+
+// Vec 等内部结构分配失败时调用, 抛出 MemoryExhausted, 由求解器入口捕获
+struct MemoryExhausted {
+    const char* where;
+};
+void mem_fail(const char* where);
+
+// 进程峰值RSS(KB), 不支持的平台返回-1
+long mem_peak_rss_kb(void);
+
+// 输出各子系统的内存使用
+void print_memory_report(const MemTracker* tracker);
+
+// 切换当前记账对象的作用域
+class MemScope {
+public:
+    explicit MemScope(MemTracker* tracker) : prev_(mem_swap_tracker(tracker)) {}
+    ~MemScope() { mem_swap_tracker(prev_); }
+private:
+    MemScope(const MemScope&);
+    MemScope& operator=(const MemScope&);
+    MemTracker* prev_;
+};
+
+#endif // MEM_TRACK_H
@@ -0,0 +1,38 @@
+#ifndef OCC_PROPAGATOR_H
+#define OCC_PROPAGATOR_H
+
+#include "clause_store.h"
+
+// =========== 只读子句库上的单元传播 ===========
+// 不学习子句的树搜索用(cube的lookahead, 并行DPLL): 直接在只读的 ClauseStore 上传播
+// 子句文字不能动, 双文字监视的两个文字单独存在 watch 里; 回退只要把trail截短,
+// 监视不用恢复
+struct OccPropagator {
+    const ClauseStore* store;
+    Vec<Vec<int> > occurs;          // 按lit_index: 含有该文字的子句(打分和选相位用)
+    Vec<Vec<int> > watches;         // 按lit_index: 监视该文字的子句
+    Vec<Literal> watch;             // 第i个子句监视 watch[2i], watch[2i+1]; 单元子句不监视
+    Vec<signed char> val;           // 按变量: TRUE/FALSE/UNASSIGNED
+    Vec<Literal> trail;
+    Vec<Variable> order;            // 出现过的变量, 按出现次数从多到少
+    int root;                       // 单元子句传播完以后trail的长度
+    long long propagations;         // 出队的文字数
+};
+
+// 建出现表并传播单元子句, 公式在第0层就矛盾返回FALSE
+// 内存不够时抛 MemoryExhausted
+int init_occ_propagator(OccPropagator* prop, const ClauseStore* store);
+
+inline int occ_value(const OccPropagator* prop, Literal lit)
+{
+    int v = prop->val[lit > 0 ? lit : -lit];
+    if (v == UNASSIGNED) return UNASSIGNED;
+    return lit > 0 ? v : !v;
+}
+
+// 赋值并传播, 矛盾返回FALSE; 不管成功与否trail都不回退, 由调用者负责
+int occ_assign(OccPropagator* prop, Literal lit);
+// 回退到trail只剩size个
+void occ_backtrack(OccPropagator* prop, int size);
+
+#endif // OCC_PROPAGATOR_H
@@ -0,0 +1,31 @@
+#ifndef PARALLEL_DPLL_H
+#define PARALLEL_DPLL_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+
+// =========== 并行DPLL树搜索 ===========
+// 不学习子句的经典DPLL: 静态变量顺序(出现次数多的先), 先试出现多的那个相位,
+// 冲突时按时间顺序回溯. 同一个节点的两个分支互不相干, 每个线程有自己的trail
+// 和决策栈, 闲下来的线程从别人栈上偷最浅的那个还没试的分支(存成决策前缀)
+// 搜索树只由公式决定, 和线程数无关; SAT时取最左边(也就是单线程最先找到)的那个解,
+// 所以跑完的话结果和模型都和单线程一样
+// 预算: config 里的 time_limit, conflict_limit, decision_limit, propagation_limit(计数按所有线程加起来),
+// 另外响应 Ctrl-C. 预算用完前已经找到过解的照样返回SAT, 但这个解不一定是最左的那个
+
+typedef struct {
+    int threads;
+    long long decisions;        // 所有线程加起来
+    long long conflicts;
+    long long propagations;
+    int tasks;                  // 执行过的子树数, 第一个是整棵树, 其余都是偷来的
+    double seconds;
+    double efficiency;          // 各线程搜索的时间之和 / (线程数 * 墙钟时间)
+    StopReason stop_reason;
+} DpllResult;
+
+// threads <= 0 时按CPU核数; SAT时模型写进assignment; result可以为NULL
+SatResult parallel_dpll_solve(const CNF* cnf, Assignment* assignment, const SolverConfig* config, int threads,
+                              DpllResult* result);
+
+#endif // PARALLEL_DPLL_H
@@ -0,0 +1,38 @@
+#ifndef PERF_PROFILE_H
+#define PERF_PROFILE_H
+
+// 硬件性能计数器采样 (Linux perf_event_open)
+// 只有通过 --profile 打开后才会真正去开计数器, 否则所有调用都是空操作
+// 非Linux平台或者没有权限(perf_event_paranoid)时自动降级, 报告里显示 n/a
+// 计数器开着的时候创建的线程(并行模式的工作线程)也计入, 数值是所有线程的总和
+
+// 采样的事件
+typedef enum {
+    PERF_EV_CYCLES,         // CPU周期
+    PERF_EV_INSTRUCTIONS,   // 指令数
+    PERF_EV_L1D_MISSES,     // L1数据缓存读缺失
+    PERF_EV_LLC_MISSES,     // 末级缓存读缺失
+    PERF_EV_BRANCH_MISSES,  // 分支预测失败
+    PERF_EV_COUNT
+} PerfEvent;
+
+// 分阶段统计
+typedef enum {
+    PERF_PHASE_PARSE,       // 读取cnf
+    PERF_PHASE_SEARCH,      // 搜索
+    PERF_PHASE_COUNT
+} PerfPhase;
+
+// 打开计数器, 返回可用计数器的个数(0表示全部不可用)
+int perf_profile_enable(void);
+// 是否处于profile模式
+int perf_profile_enabled(void);
+// 阶段开始/结束, 同一阶段可以多次进出, 数值会累加
+void perf_phase_begin(PerfPhase phase);
+void perf_phase_end(PerfPhase phase);
+// 输出每个阶段的IPC和缺失率, propagations用来算每次传播的缺失数
+void perf_profile_report(long long propagations);
+// 关闭计数器
+void perf_profile_disable(void);
+
+#endif // PERF_PROFILE_H
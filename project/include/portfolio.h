@@ -0,0 +1,45 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+
+// =========== portfolio 并行求解 ===========
+// 同一个公式开N个求解器线程, 配置各不相同(启发式, 重启, 初始相位, 种子),
+// 谁先得出SAT/UNSAT就打断其他线程. 原始子句放在一份共享的只读子句库里,
+// 内存不随线程数成倍增长
+// config.share_lbd 不为0时, 线程之间还通过 ClauseExchange 交换短的学习子句
+
+typedef struct {
+    int threads;                // 实际开的线程数
+    int winner;                 // 得出结果的线程, -1 表示都没有结果(预算用完/被取消)
+    SolverConfig winner_config;
+    SolverStats winner_stats;   // 没有winner时是0号线程的统计
+    long long total_conflicts;  // 所有线程加起来
+    long long total_propagations;
+    long long store_bytes;      // 共享子句库占用
+    long long exchange_bytes;   // 子句交换缓冲区占用, 不交换时为0
+    SolverStats* thread_stats;  // 每个线程的统计, threads个; 用完调用 free_portfolio_result
+    long long rounds;           // 确定性模式: 同步了几轮, 自由模式为0
+    double thread_seconds;      // 各线程从开始求解到结束的时间加起来(秒)
+} PortfolioResult;
+
+// 第index个线程的配置: 0号就是base, 其余轮换启发式/重启/相位, 种子各不相同
+void portfolio_config(const SolverConfig* base, int index, SolverConfig* out);
+
+// threads <= 0 时按CPU核数; SAT时模型写进assignment; result可以为NULL
+SatResult portfolio_solve(const CNF* cnf, Assignment* assignment, const SolverConfig* base,
+                          int threads, PortfolioResult* result);
+#define PORTFOLIO_SYNC_DEFAULT 20000    // 确定性模式默认每轮的传播数
+
+// 确定性模式: 各线程每轮最多跑 sync_propagations 次传播, 然后在屏障处等齐(搜索停在原地,
+// 下一轮接着走, 见 SolverEngine::resume);
+// 这一轮导出的子句按线程编号的顺序放进交换缓冲, 下一轮开始时读入. 谁先得出结果
+// 看的是轮次和线程编号, 不看时间, 所以同一个种子下结果, 模型和统计每次都一样
+// (时间预算和 Ctrl-C 除外, 它们本身就取决于时间). 冲突/决策/传播预算按每个线程算
+// sync_propagations <= 0 时用 PORTFOLIO_SYNC_DEFAULT
+SatResult portfolio_solve_deterministic(const CNF* cnf, Assignment* assignment, const SolverConfig* base,
+                                        int threads, long long sync_propagations, PortfolioResult* result);
+void free_portfolio_result(PortfolioResult* result);
+
+#endif // PORTFOLIO_H
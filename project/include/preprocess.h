@@ -0,0 +1,94 @@
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include "sat_data_structures.h"
+#include "vec.h"
+
+// =========== 预处理 ===========
+// 读进来的公式先化简再交给搜索. 化简后变量编号不变, 被消掉的变量不再出现在公式里,
+// BVA 加的辅助变量编号接在原来的变量后面. 搜索得到的模型最后用重建栈补全成原公式的模型
+
+typedef struct {
+    int subsume;                // 包含和自包含resolution, 消元前后各做一遍
+    long long subsume_budget;   // 每遍的工作量上限, 按看过的文字数
+    int probe;                  // 失败文字探测
+    long long probe_budget;     // 探测时传播看过的子句数上限
+    int substitute;             // 等价文字替换(二元蕴含图的强连通分量)
+    int bce;                    // 阻塞子句消除
+    int cce;                    // 再做覆盖子句消除(覆盖文字扩展后阻塞的子句), 要 bce 打开
+    long long bce_budget;       // 两者合起来的工作量上限, 按看过的文字数
+    int elim;                   // 变量消元(SatELite: 按子句分配, 子句数不增加才消)
+    int elim_occ_limit;         // 正负出现次数加起来超过这个的变量不试
+    int elim_resolvent_limit;   // 有resolvent比这个长就不消这个变量
+    long long elim_budget;      // 消元的工作量上限, 按算resolvent时看过的文字数
+    int gates;                  // 门识别: 结构哈希合并重复的门, 消元时只做门子句和其它子句的resolvent
+    long long gate_budget;      // 找门时看过的文字数上限(结构哈希用; 消元时算在消元的工作量里)
+    int bva;                    // 有界变量添加, 在消元之后做, 只压缩剩下的子句; 默认不做,
+                                // 加了辅助变量以后搜索常常反而变慢(数独之类的结构化公式)
+    long long bva_budget;       // 找形状时看过的文字数上限, 实际还按公式大小缩小(见 bva.cpp)
+} PreprocessOptions;
+
+typedef struct {
+    int vars_before;            // 出现在公式里的变量
+    int clauses_before;
+    long long lits_before;
+    int vars_after;
+    int clauses_after;
+    long long lits_after;
+    int fixed;                  // 化简时在第0层定下来的变量
+    int eliminated;             // 消掉的变量
+    long long resolvents;       // 消元加进来的子句
+    int probed;                 // 试过的变量
+    int failed_literals;        // 失败文字(反面成了单元)
+    int probe_units;            // 两个极性都推出的单元
+    int probe_equivalences;     // 探测出的等价文字对
+    int substituted;            // 换成等价代表文字后去掉的变量
+    int blocked;                // 阻塞子句消除删掉的子句
+    int covered;                // 覆盖子句消除删掉的子句
+    int subsumed;               // 被别的子句包含而删掉的子句
+    long long strengthened;     // 自包含resolution去掉的文字
+    int gates_and;              // 找到的 AND/OR 门
+    int gates_xor;
+    int gates_ite;
+    int gates_merged;           // 结构哈希合并掉的门
+    int gate_clauses_removed;   // 合并删掉的定义子句(减去加上的等价二元子句)
+    int gate_eliminated;        // 按门定义消掉的变量
+    int bva_variables;          // BVA 加的辅助变量
+    int bva_clauses;            // BVA 净减少的子句
+    double seconds;
+} PreprocessStats;
+
+// 重建栈: 一项是一个子句, 第一个文字是见证文字, 最后跟子句长度.
+// 从后往前看, 子句在当前赋值下不满足就把见证文字设成真
+struct Reconstruction {
+    MemTracker mem;                     // 必须在Vec之前声明
+    Vec<Literal, MEM_CLAUSES> stack;
+};
+
+void init_preprocess_options(PreprocessOptions* options);
+void init_reconstruction(Reconstruction* recon);
+
+// 化简 in, 结果写进 out(不用先初始化, 用完 free_cnf), 重建信息追加到 recon.
+// out->num_variables 可能比 in 的大(BVA), 求解用的赋值要按 out 的变量数开
+// 化简时推出矛盾的话 out 里只有一个空子句. 内存不够返回FALSE, 这时 out 没有初始化,
+// recon 不变, 直接拿 in 去求解就行
+int preprocess_cnf(const CNF* in, CNF* out, Reconstruction* recon, const PreprocessOptions* options,
+                   PreprocessStats* stats);
+
+// 把化简后公式的模型补全成原公式的模型, assignment 按化简后公式的变量数开;
+// 补全后前面原公式的那些变量就是原公式的模型
+void extend_model(const Reconstruction* recon, Assignment* assignment);
+
+// =========== 重建文件 ===========
+// 大公式化简一次, 之后拿化简后的公式换着配置反复求解: 重建栈单独存成二进制文件.
+// 格式: 魔数 "SATR", 然后是版本, 原公式的变量数, 化简后公式的变量数(含BVA辅助变量),
+// 栈长度和栈里的每个整数, 都是变长编码(每字节低7位, 最高位表示后面还有),
+// 文字先 zigzag 成非负数
+#define RECON_FILE_VERSION 2
+
+// 成功返回TRUE, 失败时已经打印了原因
+int save_reconstruction(const char* path, const Reconstruction* recon, int num_variables, int formula_variables);
+// recon 要先 init_reconstruction; 读出的栈追加在后面
+int load_reconstruction(const char* path, Reconstruction* recon, int* num_variables, int* formula_variables);
+
+#endif // PREPROCESS_H
@@ -4,9 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-// 不需要debug输出就注释掉
-#define DEBUG
+#include "sat_stats.h"
+#include "mem_track.h"
 
 // =========== 基本数据类型定义 ===========
 typedef int Literal;    // 文字, 正负之分
@@ -57,12 +56,13 @@ typedef enum {
 
 // =========== 动态数组操作函数声明 ===========
 // 后续可以考虑把他们两个合二为一
+// 会分配内存的函数返回TRUE/FALSE, 分配失败时已经打印了出错位置
 // LiteralArray操作
 
 // 初始化数组
-void init_literal_array(LiteralArray* arr);                
+int init_literal_array(LiteralArray* arr);                
 // cos一下.push_back();
-void push_literal(LiteralArray* arr, Literal lit);         
+int push_literal(LiteralArray* arr, Literal lit);         
 // 释放空间
 void free_literal_array(LiteralArray* arr);                
 // 清空
@@ -71,8 +71,8 @@ void clear_literal_array(LiteralArray* arr);
 int is_empty_literal_array(const LiteralArray* arr);       
 
 // 和上面几乎一模一样
-void init_clause_array(ClauseArray* arr);                  // 初始化子句数组
-void push_clause(ClauseArray* arr, const Clause* clause);  // 添加子句到数组
+int init_clause_array(ClauseArray* arr);                   // 初始化子句数组
+int push_clause(ClauseArray* arr, const Clause* clause);   // 添加子句到数组(深拷贝)
 void free_clause_array(ClauseArray* arr);                  // 释放子句数组内存
 void clear_clause_array(ClauseArray* arr);                 // 清空子句数组
 int is_empty_clause_array(const ClauseArray* arr);         // 检查子句数组是否为空
@@ -80,7 +80,7 @@ int is_empty_clause_array(const ClauseArray* arr);         // 检查子句数组
 // =========== CNF公式操作函数声明 ===========
 
 // 初始化CNF
-void init_cnf(CNF* cnf);    
+int init_cnf(CNF* cnf);    
 // 释放内存
 void free_cnf(CNF* cnf);                 
 // 清空              
@@ -88,30 +88,30 @@ void clear_cnf(CNF* cnf);
 // 从文件加载cnf
 int load_cnf_from_file(CNF* cnf, const char* filename); 
 // 从 src 中读取cnf给dest
-void copy_cnf(CNF* dest, const CNF* src);          
+int copy_cnf(CNF* dest, const CNF* src);          
 // 基础的判空检查    
 int is_cnf_empty(const CNF* cnf);                      
 
 // =========== 子句操作函数声明 ===========
 // 这里只是封装了一下literals, 经典左右脑互博了
-void init_clause(Clause* clause);                      
+int init_clause(Clause* clause);                      
 void free_clause(Clause* clause);                      
 // 判空
 int is_clause_empty(const Clause* clause);  
 
 // 复制子句
-void copy_clause(Clause* dest, const Clause* src);    
+int copy_clause(Clause* dest, const Clause* src);    
         
 // 检查是否为单元子句
 int is_unit_clause(const Clause* clause);             
 
 // =========== 赋值操作函数声明 ===========
 // 初始化赋值结构
-void init_assignment(Assignment* assign, int num_variables); 
+int init_assignment(Assignment* assign, int num_variables); 
 // 释放赋值结构内存 
 void free_assignment(Assignment* assign);                     
 // 复制赋值结构
-void copy_assignment(Assignment* dest, const Assignment* src); 
+int copy_assignment(Assignment* dest, const Assignment* src); 
 // 清空所有赋值
 void clear_assignment(Assignment* assign);                    
 
@@ -0,0 +1,30 @@
+#ifndef SAT_STATS_H
+#define SAT_STATS_H
+
+// =========== 编译期统计级别 ===========
+// 由CMake选项 SAT_STATS_LEVEL (off / counters / full) 传入, 取代以前写死的 #define DEBUG
+//   off      : 只留预算要用的冲突/决策/传播数, 其余计数器和状态输出都去掉
+//   counters : 计数器 + 每2秒一次的状态输出 + 最终统计
+//   full     : 在counters基础上打印每次决策/回溯的跟踪信息
+#define SAT_STATS_OFF       0
+#define SAT_STATS_COUNTERS  1
+#define SAT_STATS_FULL      2
+
+#ifndef SAT_STATS_LEVEL
+#define SAT_STATS_LEVEL SAT_STATS_COUNTERS
+#endif
+
+// 常量开关, 用普通的if就能被编译器整段删掉
+constexpr bool kStatsCounters = SAT_STATS_LEVEL >= SAT_STATS_COUNTERS;
+constexpr bool kStatsFull = SAT_STATS_LEVEL >= SAT_STATS_FULL;
+
+// 跟踪输出, 只在full级别存在
+#if SAT_STATS_LEVEL >= SAT_STATS_FULL
+    #define DEBUG_PRINT(...) printf(__VA_ARGS__)
+    #define DEBUG_FLUSH() fflush(stdout)
+#else
+    #define DEBUG_PRINT(...) do {} while (0)
+    #define DEBUG_FLUSH() do {} while (0)
+#endif
+
+#endif // SAT_STATS_H
@@ -0,0 +1,1388 @@
+#ifndef SEARCH_ENGINE_H
+#define SEARCH_ENGINE_H
+
+#include "search_policies.h"
+#include "clause_exchange.h"
+#include "equivalence.h"
+#include "trace.h"
+#include <atomic>
+
+// =========== 策略化的CDCL搜索 ===========
+// 每种 <启发式, 传播, 重启, 统计> 组合都是独立实例化的一份代码,
+// 内层循环里对策略的调用全部是静态分派, 可以完全内联
+
+// reduce_db 排序用
+typedef struct {
+    int cref;
+    int lbd;
+    float activity;
+} ReduceCandidate;
+
+// 差的排前面: LBD大的, 同LBD时活跃度低的
+inline int compare_reduce_candidates(const void* a, const void* b)
+{
+    const ReduceCandidate* x = (const ReduceCandidate*)a;
+    const ReduceCandidate* y = (const ReduceCandidate*)b;
+    if (x->lbd != y->lbd) return x->lbd > y->lbd ? -1 : 1;
+    if (x->activity != y->activity) return x->activity < y->activity ? -1 : 1;
+    return 0;
+}
+
+// 搜索中化简的候选(子句或变量), key 小的先做, 相同时按编号
+typedef struct {
+    int item;
+    int key;
+} InprocessCandidate;
+
+inline int compare_inprocess_candidates(const void* a, const void* b)
+{
+    const InprocessCandidate* x = (const InprocessCandidate*)a;
+    const InprocessCandidate* y = (const InprocessCandidate*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->item - y->item;
+}
+
+#define INPROCESS_MIN_EFFORT 10000      // 每种技术每轮至少这么多工作量
+#define INPROCESS_PROPAGATION_COST 3    // 探测和活化在浅层传播, 监视表看得多, 一次传播按搜索里的这么多次算
+#define INPROCESS_ELIM_OCC 16           // 消去的变量最多出现在这么多个原始子句里
+#define INPROCESS_ELIM_RESOLVENT 20     // resolvent 最长这么多个文字
+
+template <class Heuristic, class Propagation, class Restart, class Stats>
+class SearchEngine : public SolverEngine {
+public:
+    explicit SearchEngine(const SolverConfig& config)
+        : config_(config), broken_(FALSE), interrupted_(0), deadline_(0), conflict_stop_(0),
+          decision_stop_(0), propagation_stop_(0), limit_tick_(0), slice_(0), next_progress_(0),
+          budget_(NULL), charged_conflicts_(0), charged_decisions_(0), charged_propagations_(0), exchange_(NULL),
+          exchange_id_(0), exchange_cursor_(0), share_credit_(0), next_reduce_(2000), reduce_inc_(300),
+          next_inprocess_(config.inprocess_interval), inprocess_propagations_(0), num_substituted_(0),
+          num_eliminated_(0), probe_cursor_(0), lbd_stamp_counter_(0)
+    {
+        init_mem_tracker(&mem_, config.mem_limit);
+        MemScope scope(&mem_);
+        try {
+            st_.init(&mem_);
+            st_.rng = config.seed != 0 ? config.seed : 1;
+            heur_.init(st_, config);
+            restart_.init(config);
+        } catch (const MemoryExhausted&) {
+            on_memory_exhausted();
+        }
+    }
+
+    // 分配失败后状态可能不完整, 之后的调用一律返回UNKNOWN
+    int add_clause(const Literal* lits, int size) { return add_clause_guarded(lits, size, FALSE); }
+    int add_shared_clause(const Literal* lits, int size) { return add_clause_guarded(lits, size, TRUE); }
+
+    using SolverEngine::solve;
+
+    SatResult solve(const Literal* assumptions, int count) { return solve_guarded(assumptions, count, 0); }
+    SatResult resume(long long propagations) { return solve_guarded(NULL, 0, propagations > 0 ? propagations : 1); }
+
+    int model_value(Variable var) const
+    {
+        if (var <= 0 || var >= st_.model.size()) return FALSE;
+        return st_.model[var];
+    }
+
+    int num_variables() const { return st_.num_vars; }
+    const SolverStats& stats() const { return st_.stats; }
+
+    const Literal* failed_assumptions(int* count) const
+    {
+        *count = failed_.size();
+        return failed_.data();
+    }
+    void interrupt() { interrupted_.store(1); }
+
+    void connect_exchange(ClauseExchange* exchange, int id)
+    {
+        exchange_ = exchange;
+        exchange_id_ = id;
+        exchange_cursor_ = exchange ? exchange->start_cursor() : 0;
+        share_credit_ = 0;
+    }
+
+    void share_budget(SolverBudget* budget) { budget_ = budget; }
+
+private:
+    // slice > 0 是 resume: 最多做这么多次传播就停在原地, 不回第0层
+    SatResult solve_guarded(const Literal* assumptions, int count, long long slice)
+    {
+        failed_.clear();
+        if (broken_) {
+            st_.stats.stop_reason = STOP_MEMORY;
+            return UNKNOWN;
+        }
+        MemScope scope(&mem_);
+        SatResult result;
+        try {
+            // 上一次 resume 可能停在半路
+            if (slice == 0) backtrack(0);
+            slice_ = slice;
+            assumptions_.clear();
+            int max_var = 0;
+            for (int i = 0; i < count; i++)
+                if (lit_var(assumptions[i]) > max_var) max_var = lit_var(assumptions[i]);
+            grow_vars(max_var);
+            // 假设也换成等价代表, 失败的假设最后再对回原来的文字; 被消掉的变量先恢复
+            for (int i = 0; i < count; i++) {
+                Literal a = representative(assumptions[i]);
+                if (eliminated_[lit_var(a)]) {
+                    restore_variable(lit_var(a));
+                    a = representative(assumptions[i]);
+                }
+                assumptions_.push(a);
+            }
+            result = solve_impl();
+            if (result == UNSAT && failed_.size() > 0 && num_substituted_ > 0) map_failed(assumptions, count);
+        } catch (const MemoryExhausted&) {
+            on_memory_exhausted();
+            result = UNKNOWN;
+        }
+        slice_ = 0;
+        st_.stats.memory = mem_;
+        interrupted_.store(0);
+        return result;
+    }
+
+    void on_memory_exhausted()
+    {
+        broken_ = TRUE;
+        st_.stats.stop_reason = STOP_MEMORY;
+        st_.stats.memory = mem_;
+    }
+
+    int add_clause_guarded(const Literal* lits, int size, int shared)
+    {
+        if (broken_) return FALSE;
+        MemScope scope(&mem_);
+        try {
+            return add_clause_impl(lits, size, shared);
+        } catch (const MemoryExhausted&) {
+            on_memory_exhausted();
+            return FALSE;
+        }
+    }
+
+    // shared: 子句没有被化简时直接引用 lits, 否则还是复制化简后的版本
+    int add_clause_impl(const Literal* lits, int size, int shared)
+    {
+        if (!st_.ok) return FALSE;
+        if (st_.decision_level() > 0) backtrack(0);
+
+        int max_var = 0;
+        for (int i = 0; i < size; i++)
+            if (lit_var(lits[i]) > max_var) max_var = lit_var(lits[i]);
+        grow_vars(max_var);
+        // 被消掉的变量先恢复: 会递归地加子句, 所以要在用 add_tmp_ 之前
+        for (int i = 0; i < size && num_eliminated_ > 0 && st_.ok; i++) {
+            Variable v = lit_var(representative(lits[i]));
+            if (eliminated_[v]) restore_variable(v);
+        }
+        if (!st_.ok) return FALSE;
+
+        // 去重, 去掉第0层为假的文字, 重言式和已满足的直接丢掉
+        // seen: 1 表示正文字已出现, 2 表示负文字已出现
+        // 被等价替换掉的变量换成代表文字, 换过的子句不能再直接引用 lits
+        add_tmp_.clear();
+        int skip = FALSE, changed = FALSE;
+        for (int i = 0; i < size && !skip; i++) {
+            Literal l = representative(lits[i]);
+            if (l != lits[i]) changed = TRUE;
+            Variable v = lit_var(l);
+            char mark = (char)(l > 0 ? 1 : 2);
+            int val = st_.value(l);
+            if (val == TRUE || (st_.seen[v] != 0 && st_.seen[v] != mark)) skip = TRUE;
+            else if (val == UNASSIGNED && st_.seen[v] == 0) {
+                st_.seen[v] = mark;
+                add_tmp_.push(l);
+            }
+        }
+        for (int i = 0; i < add_tmp_.size(); i++) st_.seen[lit_var(add_tmp_[i])] = 0;
+        if (skip) return TRUE;
+
+        if (add_tmp_.size() == 0) {
+            st_.ok = FALSE;
+            return FALSE;
+        }
+        if (add_tmp_.size() == 1) {
+            st_.assign(add_tmp_[0], CREF_NONE);
+            if (propagate() != CREF_NONE) st_.ok = FALSE;
+            return st_.ok;
+        }
+
+        int cref = shared && !changed && add_tmp_.size() == size ? st_.alloc_shared_clause(lits, size)
+                                                     : st_.alloc_clause(add_tmp_.data(), add_tmp_.size(), FALSE);
+        prop_.attach(st_, cref);
+        heur_.on_clause(st_, add_tmp_.data(), add_tmp_.size());
+        return TRUE;
+    }
+
+    SatResult solve_impl()
+    {
+        st_.model.clear();
+        st_.stats.stop_reason = STOP_NONE;
+        if (!st_.ok) return UNSAT;
+        // resume 接着上一段时不在第0层, 导入子句要等下一次重启, 传播交给 search
+        if (st_.decision_level() == 0) {
+            // 上次 solve 之后别的线程导出的也先读进来
+            if (exchange_ && !import_shared()) return UNSAT;
+            if (propagate() != CREF_NONE) {
+                st_.ok = FALSE;
+                return UNSAT;
+            }
+        }
+        set_budgets();
+
+        SatResult result = UNKNOWN;
+        while (result == UNKNOWN && st_.stats.stop_reason == STOP_NONE) {
+            // 两次重启之间算一个搜索epoch
+#if TRACE_ENABLED
+            long long epoch_start = trace_now_us();
+#endif
+            result = search();
+#if TRACE_ENABLED
+            if (trace_active()) trace_complete("search epoch", epoch_start, trace_now_us());
+#endif
+            if (result == UNKNOWN && st_.stats.stop_reason == STOP_NONE) {
+                if (Stats::counters) st_.stats.restarts++;
+                restart_.on_restart();
+                TRACE_INSTANT("restart");
+                if (exchange_ && !import_shared()) result = UNSAT;
+                if (result == UNKNOWN && config_.inprocess_interval > 0 && st_.stats.conflicts >= next_inprocess_) {
+                    next_inprocess_ = st_.stats.conflicts + config_.inprocess_interval;
+                    if (!inprocess()) result = UNSAT;
+                }
+            }
+        }
+        if (!slice_ || result != UNKNOWN) backtrack(0);
+        return result;
+    }
+
+    // 预算按这一次 solve 算, 换算成计数器的绝对值
+    // 接了共用预算时截止时刻用它的, 计数从这里开始往上加
+    void set_budgets()
+    {
+        const SolverStats& s = st_.stats;
+        if (budget_) {
+            deadline_ = budget_->deadline;
+            conflict_stop_ = decision_stop_ = propagation_stop_ = 0;
+            charged_conflicts_ = s.conflicts;
+            charged_decisions_ = s.decisions;
+            charged_propagations_ = s.propagations;
+        } else {
+            deadline_ = config_.time_limit > 0 ? solver_wall_seconds() + config_.time_limit : 0;
+            conflict_stop_ = config_.conflict_limit > 0 ? s.conflicts + config_.conflict_limit : 0;
+            decision_stop_ = config_.decision_limit > 0 ? s.decisions + config_.decision_limit : 0;
+            propagation_stop_ = config_.propagation_limit > 0 ? s.propagations + config_.propagation_limit : 0;
+        }
+        // resume 的这一段也算成传播预算, 取两者先到的
+        if (slice_ > 0 && (propagation_stop_ == 0 || s.propagations + slice_ < propagation_stop_))
+            propagation_stop_ = s.propagations + slice_;
+        limit_tick_ = 0;
+        next_progress_ = config_.progress ? solver_wall_seconds() + config_.progress_interval : 0;
+    }
+
+    // 每个冲突和决策之前检查一次; 计数器直接比较, 时钟每256次才读一次
+    // 进度回调也在这里按时间间隔触发
+    // 用完了记下原因, 返回TRUE
+    int out_of_budget()
+    {
+        SolverStats& s = st_.stats;
+        StopReason why = budget_ ? charge_budget() : STOP_NONE;
+        if (why != STOP_NONE) {
+        } else if (conflict_stop_ && s.conflicts >= conflict_stop_) why = STOP_CONFLICTS;
+        else if (decision_stop_ && s.decisions >= decision_stop_) why = STOP_DECISIONS;
+        else if (propagation_stop_ && s.propagations >= propagation_stop_) why = STOP_PROPAGATIONS;
+        else if (interrupted_.load(std::memory_order_relaxed) || cancel_requested()) why = STOP_CANCELLED;
+        else if ((deadline_ > 0 || next_progress_ > 0) && (++limit_tick_ & 255) == 0) {
+            double now = solver_wall_seconds();
+            if (deadline_ > 0 && now >= deadline_) why = STOP_TIME;
+            else if (next_progress_ > 0 && now >= next_progress_) {
+                next_progress_ = now + config_.progress_interval;
+                s.memory = mem_;
+                config_.progress(&s, config_.progress_user);
+            }
+        }
+        if (why == STOP_NONE) return FALSE;
+        s.stop_reason = why;
+        return TRUE;
+    }
+
+    // 把上次以来的计数加到共用预算上, 看总数有没有到上限
+    // 没有计数上限时不碰原子变量, 只用它的截止时刻
+    StopReason charge_budget()
+    {
+        SolverBudget* b = budget_;
+        if (!b->conflict_limit && !b->decision_limit && !b->propagation_limit) return STOP_NONE;
+        const SolverStats& s = st_.stats;
+        long long dc = s.conflicts - charged_conflicts_;
+        long long dd = s.decisions - charged_decisions_;
+        long long dp = s.propagations - charged_propagations_;
+        long long conflicts = b->conflicts.fetch_add(dc) + dc;
+        long long decisions = b->decisions.fetch_add(dd) + dd;
+        long long propagations = b->propagations.fetch_add(dp) + dp;
+        charged_conflicts_ = s.conflicts;
+        charged_decisions_ = s.decisions;
+        charged_propagations_ = s.propagations;
+        if (b->conflict_limit && conflicts >= b->conflict_limit) return STOP_CONFLICTS;
+        if (b->decision_limit && decisions >= b->decision_limit) return STOP_DECISIONS;
+        if (b->propagation_limit && propagations >= b->propagation_limit) return STOP_PROPAGATIONS;
+        return STOP_NONE;
+    }
+
+    // =========== 子句交换 ===========
+
+    // 刚学到的子句(learnt_)符合条件就导出
+    // 速率上限: 每个冲突攒 share_rate 个文字的额度, 最多攒1000个冲突的, 导出时扣掉子句长度
+    void export_learnt(int lbd)
+    {
+        share_credit_ += config_.share_rate;
+        if (share_credit_ > 1000LL * config_.share_rate) share_credit_ = 1000LL * config_.share_rate;
+
+        int size = learnt_.size();
+        int max_size = config_.share_max_size < EXCHANGE_MAX_SIZE ? config_.share_max_size : EXCHANGE_MAX_SIZE;
+        if (size > max_size || (size > 1 && lbd > config_.share_lbd)) return;
+        if (size > 1) {
+            if (share_credit_ < size) {
+                if (Stats::counters) st_.stats.shared_dropped++;
+                return;
+            }
+            share_credit_ -= size;
+        }
+        int published = exchange_->publish(exchange_id_, learnt_.data(), size, lbd);
+        if (Stats::counters) {
+            if (published) st_.stats.shared_exported++;
+            else st_.stats.shared_dropped++;
+        }
+    }
+
+    // 重启后(第0层)读入别的线程导出的子句, 当作学习子句; 一次最多读四分之一个环
+    // 导入的子句蕴含出第0层矛盾时返回FALSE
+    int import_shared()
+    {
+        Literal lits[EXCHANGE_MAX_SIZE];
+        int size, lbd;
+        for (int n = 0; n < EXCHANGE_CAPACITY / 4; n++) {
+            if (!exchange_->fetch(&exchange_cursor_, exchange_id_, lits, &size, &lbd, &st_.stats.shared_missed))
+                break;
+            // 换成等价代表, 去掉第0层为假的文字和重复文字, 已满足的和重言式不要;
+            // 含被消掉的变量的也不要(它是原公式的推论, 丢掉不影响正确性)
+            int k = 0, skip = FALSE;
+            for (int i = 0; i < size && !skip; i++) {
+                if (lit_var(lits[i]) > st_.num_vars) {
+                    skip = TRUE;
+                    break;
+                }
+                Literal l = representative(lits[i]);
+                char mark = (char)(l > 0 ? 1 : 2);
+                char seen = st_.seen[lit_var(l)];
+                if (st_.value(l) == TRUE || (seen != 0 && seen != mark) || eliminated_[lit_var(l)]) skip = TRUE;
+                else if (st_.value(l) == UNASSIGNED && seen == 0) {
+                    st_.seen[lit_var(l)] = mark;
+                    lits[k++] = l;
+                }
+            }
+            for (int i = 0; i < k; i++) st_.seen[lit_var(lits[i])] = 0;
+            if (skip) continue;
+            if (Stats::counters) st_.stats.shared_imported++;
+            if (k == 0) {
+                st_.ok = FALSE;
+                return FALSE;
+            }
+            if (k == 1) {
+                st_.assign(lits[0], CREF_NONE);
+            } else {
+                int cref = st_.alloc_clause(lits, k, TRUE);
+                st_.clauses[cref].lbd = lbd < k ? lbd : k;
+                prop_.attach(st_, cref);
+                heur_.on_clause(st_, lits, k);
+            }
+        }
+        return TRUE;
+    }
+
+    void grow_vars(int n)
+    {
+        if (n <= st_.num_vars) return;
+        int old = st_.num_vars;
+        st_.grow_vars(n);
+        if (config_.phase != PHASE_FALSE) {
+            for (Variable v = old + 1; v <= n; v++)
+                st_.polarity[v] = (signed char)(config_.phase == PHASE_TRUE ? TRUE : (st_.next_random() & 1));
+        }
+        prop_.grow_vars(st_);
+        heur_.grow_vars(st_);
+        subst_.grow_to(n + 1, 0);
+        eliminated_.grow_to(n + 1, 0);
+    }
+
+    // 沿着等价替换找到代表文字, 没被替换的就是自己
+    Literal representative(Literal lit) const
+    {
+        if (num_substituted_ == 0) return lit;
+        while (subst_[lit_var(lit)] != 0) lit = lit > 0 ? subst_[lit] : -subst_[-lit];
+        return lit;
+    }
+
+    // failed_ 里是换过的假设, 对回调用者给的原文字
+    void map_failed(const Literal* assumptions, int count)
+    {
+        add_tmp_.clear();
+        for (int i = 0; i < count; i++) {
+            Literal a = representative(assumptions[i]);
+            for (int k = 0; k < failed_.size(); k++) {
+                if (failed_[k] != a) continue;
+                add_tmp_.push(assumptions[i]);
+                break;
+            }
+        }
+        add_tmp_.copy_to(failed_);
+    }
+
+    int propagate()
+    {
+        int before = st_.qhead;
+        int confl = prop_.propagate(st_);
+        st_.stats.propagations += st_.qhead - before;
+        return confl;
+    }
+
+    void backtrack(int target_level)
+    {
+        if (st_.decision_level() <= target_level) return;
+        int stop = st_.trail_lim[target_level];
+        for (int i = st_.trail.size() - 1; i >= stop; i--) {
+            Literal l = st_.trail[i];
+            if (i < st_.qhead) prop_.on_unassign(st_, l);
+            st_.unassign(l);
+            heur_.on_unassign(lit_var(l));
+        }
+        st_.trail.shrink(stop);
+        st_.trail_lim.shrink(target_level);
+        st_.qhead = stop;
+    }
+
+    void bump_clause(CoreClause& c)
+    {
+        if ((c.activity += (float)st_.clause_inc) > 1e20f) {
+            for (int i = 0; i < st_.clauses.size(); i++)
+                if (st_.clauses[i].learnt) st_.clauses[i].activity *= 1e-20f;
+            st_.clause_inc *= 1e-20;
+        }
+    }
+
+    // 假设p为假时, 沿原因子句往回找是哪些假设导致的, 结果放在failed_里(包括p本身)
+    void analyze_final(Literal p)
+    {
+        failed_.clear();
+        failed_.push(p);
+        Variable pv = lit_var(p);
+        if (st_.decision_level() == 0 || st_.level[pv] == 0) return;
+
+        st_.seen[pv] = 1;
+        for (int i = st_.trail.size() - 1; i >= st_.trail_lim[0]; i--) {
+            Variable x = lit_var(st_.trail[i]);
+            if (!st_.seen[x]) continue;
+            int r = st_.reason[x];
+            if (r == CREF_NONE) {
+                // 第0层以上没有原因的只能是假设(p和-p都被假设时这里就是-p)
+                failed_.push(st_.trail[i]);
+            } else {
+                const CoreClause& c = st_.clauses[r];
+                for (int k = 0; k < c.size; k++) {
+                    Variable v = lit_var(c.lits[k]);
+                    if (v != x && st_.level[v] > 0) st_.seen[v] = 1;
+                }
+            }
+            st_.seen[x] = 0;
+        }
+    }
+
+    // 第一UIP冲突分析, 结果放在learnt_里, learnt_[0]是断言文字
+    void analyze(int confl, int* out_btlevel, int* out_lbd)
+    {
+        learnt_.clear();
+        learnt_.push(0);
+        int path = 0;
+        Literal p = 0;
+        int index = st_.trail.size() - 1;
+
+        do {
+            CoreClause& c = st_.clauses[confl];
+            if (c.learnt) bump_clause(c);
+            for (int k = 0; k < c.size; k++) {
+                Literal q = c.lits[k];
+                if (q == p) continue;
+                Variable v = lit_var(q);
+                if (!st_.seen[v] && st_.level[v] > 0) {
+                    st_.seen[v] = 1;
+                    heur_.bump(v);
+                    if (st_.level[v] >= st_.decision_level()) path++;
+                    else learnt_.push(q);
+                }
+            }
+            // 沿trail往回找下一个标记过的文字
+            while (!st_.seen[lit_var(st_.trail[index])]) index--;
+            p = st_.trail[index];
+            index--;
+            confl = st_.reason[lit_var(p)];
+            st_.seen[lit_var(p)] = 0;
+            path--;
+        } while (path > 0);
+        learnt_[0] = -p;
+        minimize_learnt();
+
+        // 第二个位置放层数最高的文字, 它就是回跳层
+        int btlevel = 0;
+        if (learnt_.size() > 1) {
+            int max_i = 1;
+            for (int i = 2; i < learnt_.size(); i++)
+                if (st_.level[lit_var(learnt_[i])] > st_.level[lit_var(learnt_[max_i])]) max_i = i;
+            Literal tmp = learnt_[1];
+            learnt_[1] = learnt_[max_i];
+            learnt_[max_i] = tmp;
+            btlevel = st_.level[lit_var(learnt_[1])];
+        }
+        for (int i = 0; i < analyze_clear_.size(); i++) st_.seen[lit_var(analyze_clear_[i])] = 0;
+
+        *out_btlevel = btlevel;
+        *out_lbd = compute_lbd(learnt_.data(), learnt_.size());
+    }
+
+    // =========== 学习子句的递归最小化 ===========
+    // 学习子句里的文字q, 如果它的原因子句里的其它文字都在学习子句里, 或者它们自己也能这样递归地
+    // 推出来(都是第0层的不算), 那么q和学习子句其余部分resolve掉也不会引入新文字, 可以去掉.
+    // 递归只走到学习子句里出现过的决策层(层号的32位摘要筛一下), 走不通的马上撤销这次的标记
+    // 调用时学习子句的文字(除了 learnt_[0])在 seen 上有标记; analyze_clear_ 收集所有要清掉的标记
+    void minimize_learnt()
+    {
+        learnt_.copy_to(analyze_clear_);
+        unsigned int levels = 0;
+        for (int i = 1; i < learnt_.size(); i++) levels |= abstract_level(lit_var(learnt_[i]));
+        int j = 1;
+        for (int i = 1; i < learnt_.size(); i++) {
+            Literal q = learnt_[i];
+            if (st_.reason[lit_var(q)] == CREF_NONE || !literal_redundant(q, levels)) learnt_[j++] = q;
+        }
+        if (Stats::counters) st_.stats.minimized_literals += learnt_.size() - j;
+        learnt_.shrink(j);
+    }
+
+    unsigned int abstract_level(Variable v) const { return 1u << (st_.level[v] & 31); }
+
+    int literal_redundant(Literal q, unsigned int levels)
+    {
+        analyze_stack_.clear();
+        analyze_stack_.push(q);
+        int top = analyze_clear_.size();
+        while (analyze_stack_.size() > 0) {
+            Variable x = lit_var(analyze_stack_.last());
+            analyze_stack_.pop();
+            const CoreClause& c = st_.clauses[st_.reason[x]];
+            for (int k = 0; k < c.size; k++) {
+                Variable v = lit_var(c.lits[k]);
+                if (v == x || st_.seen[v] || st_.level[v] == 0) continue;
+                if (st_.reason[v] == CREF_NONE || !(abstract_level(v) & levels)) {
+                    for (int i = top; i < analyze_clear_.size(); i++) st_.seen[lit_var(analyze_clear_[i])] = 0;
+                    analyze_clear_.shrink(top);
+                    return FALSE;
+                }
+                st_.seen[v] = 1;
+                analyze_stack_.push(c.lits[k]);
+                analyze_clear_.push(c.lits[k]);
+            }
+        }
+        return TRUE;
+    }
+
+    int compute_lbd(const Literal* lits, int size)
+    {
+        lbd_stamp_.grow_to(st_.decision_level() + 1, 0);
+        lbd_stamp_counter_++;
+        int lbd = 0;
+        for (int i = 0; i < size; i++) {
+            int lv = st_.level[lit_var(lits[i])];
+            if (lbd_stamp_[lv] != lbd_stamp_counter_) {
+                lbd_stamp_[lv] = lbd_stamp_counter_;
+                lbd++;
+            }
+        }
+        return lbd;
+    }
+
+    // 删掉一半不重要的学习子句, LBD<=2的一直保留
+    // aggressive: 内存超限时用, 没被锁住的学习子句全部删掉
+    void reduce_db(int aggressive)
+    {
+        TRACE_SCOPE("reduce_db");
+        reduce_tmp_.clear();
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (!c.learnt || c.deleted || (c.lbd <= 2 && !aggressive) || st_.is_locked(i)) continue;
+            ReduceCandidate rc = { i, c.lbd, c.activity };
+            reduce_tmp_.push(rc);
+        }
+        qsort(reduce_tmp_.data(), reduce_tmp_.size(), sizeof(ReduceCandidate), compare_reduce_candidates);
+        int remove = aggressive ? reduce_tmp_.size() : reduce_tmp_.size() / 2;
+        if (remove == 0) return;
+        for (int i = 0; i < remove; i++) st_.clauses[reduce_tmp_[i].cref].deleted = 1;
+        prop_.purge(st_);
+        for (int i = 0; i < remove; i++) st_.free_clause(reduce_tmp_[i].cref);
+        if (Stats::counters) st_.stats.deleted_clauses += remove;
+        TRACE_COUNTER("learned clauses", st_.num_learnts);
+    }
+
+    // =========== 搜索中的化简 ===========
+    // 每隔 inprocess_interval 个冲突, 在重启后(第0层)按 InprocessTechnique 的顺序做一轮.
+    // 每种技术的工作量是上一轮以来传播次数的 inprocess_effort 千分之一, 至少 INPROCESS_MIN_EFFORT;
+    // 探测和活化按传播次数算, 包含和消去按看过的文字数算.
+    // 改子句一律复制一份新的再删旧的: 原始子句可能直接引用共享的只读子句库, 不能原地改.
+    // 删掉的先只打标记, 每种技术做完时统一摘掉监视再释放(finish_pass)
+    // 第0层推出矛盾时返回FALSE
+    int inprocess()
+    {
+        TRACE_SCOPE("inprocess");
+        if (propagate() != CREF_NONE) {
+            st_.ok = FALSE;
+            return FALSE;
+        }
+        long long effort = (st_.stats.propagations - inprocess_propagations_) * config_.inprocess_effort / 1000;
+        if (effort < INPROCESS_MIN_EFFORT) effort = INPROCESS_MIN_EFFORT;
+        for (int t = 0; t < INPROCESS_COUNT && st_.ok; t++) {
+            if (!(config_.inprocess_mask & (1 << t))) continue;
+            InprocessStats& is = st_.stats.inprocess[t];
+            double start = Stats::counters ? solver_wall_seconds() : 0;
+            int fixed = st_.trail.size();
+            sub_removed_.clear();
+            sub_units_.clear();
+            switch (t) {
+            case INPROCESS_PROBE: probe_failed(effort / INPROCESS_PROPAGATION_COST, is); break;
+            case INPROCESS_SUBSTITUTE: substitute_equivalences(is); break;
+            case INPROCESS_SUBSUME: subsume_learnts(effort, is); break;
+            case INPROCESS_VIVIFY: vivify_learnts(effort / INPROCESS_PROPAGATION_COST, is); break;
+            case INPROCESS_ELIM: eliminate_variables(effort, is); break;
+            }
+            finish_pass();
+            if (Stats::counters) {
+                is.calls++;
+                is.variables += st_.trail.size() - fixed;
+                is.seconds += solver_wall_seconds() - start;
+            }
+        }
+        inprocess_propagations_ = st_.stats.propagations;
+        TRACE_COUNTER("original clauses", st_.num_originals);
+        return st_.ok;
+    }
+
+    // 释放这一遍删掉的子句, 给缩短出来的单元赋值并传播
+    void finish_pass()
+    {
+        if (sub_removed_.size() > 0) {
+            prop_.purge(st_);
+            for (int i = 0; i < sub_removed_.size(); i++) st_.free_clause(sub_removed_[i]);
+            sub_removed_.clear();
+        }
+        // 单元留到最后再赋值: 计数传播的 attach 要求已赋值的文字都传播过
+        for (int i = 0; i < sub_units_.size() && st_.ok; i++) {
+            int val = st_.value(sub_units_[i]);
+            if (val == FALSE) st_.ok = FALSE;
+            else if (val == UNASSIGNED) st_.assign(sub_units_[i], CREF_NONE);
+        }
+        sub_units_.clear();
+        if (st_.ok && propagate() != CREF_NONE) st_.ok = FALSE;
+    }
+
+    // 先只打删除标记, 监视表在这一遍结束时统一清理
+    void remove_subsumed(int cref)
+    {
+        st_.clauses[cref].deleted = 1;
+        sub_removed_.push(cref);
+    }
+
+    // 用 add_tmp_ 里的文字换掉子句, 学习标记/LBD/活跃度照旧. 返回新的cref,
+    // 剩一个文字时记成单元, 没有文字时公式矛盾, 这两种返回 CREF_NONE
+    int replace_clause(int cref)
+    {
+        const CoreClause& d = st_.clauses[cref];
+        int learnt = d.learnt, lbd = d.lbd, vivified = d.vivified;
+        float activity = d.activity;
+        remove_subsumed(cref);
+        if (add_tmp_.size() == 0) {
+            st_.ok = FALSE;
+            return CREF_NONE;
+        }
+        if (add_tmp_.size() == 1) {
+            sub_units_.push(add_tmp_[0]);
+            return CREF_NONE;
+        }
+        int fresh = st_.alloc_clause(add_tmp_.data(), add_tmp_.size(), learnt);
+        CoreClause& c = st_.clauses[fresh];
+        c.lbd = lbd < c.size ? lbd : c.size;
+        c.activity = activity;
+        c.vivified = (unsigned char)vivified;
+        prop_.attach(st_, fresh);
+        return fresh;
+    }
+
+    // 候选排好序放在 cand_ 里
+    void sort_candidates()
+    {
+        qsort(cand_.data(), cand_.size(), sizeof(InprocessCandidate), compare_inprocess_candidates);
+    }
+
+    // =========== 失败文字探测 ===========
+    // 在第1层试探一个文字并传播: 矛盾说明它的反面是第0层单元; 两个极性都推出的文字也是单元.
+    // 只有反面出现在二元子句里的文字才推得出东西, 二元蕴含图的根先试, 出边多的先试;
+    // 每一轮从上一轮停下的位置接着试
+    void probe_failed(long long budget, InprocessStats& is)
+    {
+        (void)is;
+        probe_bins_.clear();
+        probe_bins_.grow_to(2 * st_.num_vars + 2, 0);
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (c.deleted || c.size != 2) continue;
+            if (st_.value(c.lits[0]) != UNASSIGNED || st_.value(c.lits[1]) != UNASSIGNED) continue;
+            probe_bins_[lit_index(c.lits[0])]++;
+            probe_bins_[lit_index(c.lits[1])]++;
+        }
+        cand_.clear();
+        for (Variable v = 1; v <= st_.num_vars; v++) {
+            if (st_.value(v) != UNASSIGNED || eliminated_[v] || subst_[v] != 0) continue;
+            int pos = probe_bins_[lit_index(v)], neg = probe_bins_[lit_index(-v)];
+            if (pos + neg == 0) continue;
+            int rank = (pos == 0 || neg == 0) ? 0 : 1;
+            InprocessCandidate ic = { v, rank * (1 << 24) - (pos + neg) };
+            cand_.push(ic);
+        }
+        sort_candidates();
+        probe_implied_.grow_to(st_.num_vars + 1, (signed char)UNASSIGNED);
+
+        long long stop = st_.stats.propagations + budget;
+        int n = cand_.size();
+        for (int i = 0; i < n && st_.ok && st_.stats.propagations < stop; i++) {
+            Variable v = cand_[(probe_cursor_ + i) % n].item;
+            if (st_.value(v) == UNASSIGNED) probe_variable(v);
+        }
+        probe_cursor_ = n > 0 ? (probe_cursor_ + n / 4 + 1) % n : 0;
+    }
+
+    // 开一层试探 lit 并传播, 没有矛盾返回TRUE; 调用者负责退回第0层
+    int probe_literal(Literal lit)
+    {
+        st_.trail_lim.push(st_.trail.size());
+        st_.assign(lit, CREF_NONE);
+        return propagate() == CREF_NONE;
+    }
+
+    void probe_variable(Variable v)
+    {
+        int start = st_.trail.size();
+        probe_units_.clear();
+        if (!probe_literal(v)) {
+            backtrack(0);
+            probe_units_.push(-v);
+        } else {
+            probe_trail_.clear();
+            for (int i = start + 1; i < st_.trail.size(); i++) {
+                Literal y = st_.trail[i];
+                probe_trail_.push(y);
+                probe_implied_[lit_var(y)] = (signed char)(y > 0 ? TRUE : FALSE);
+            }
+            backtrack(0);
+            if (!probe_literal(-v)) probe_units_.push(v);
+            else {
+                for (int i = start + 1; i < st_.trail.size(); i++) {
+                    Literal y = st_.trail[i];
+                    if (probe_implied_[lit_var(y)] == (y > 0 ? TRUE : FALSE)) probe_units_.push(y);
+                }
+            }
+            backtrack(0);
+            for (int i = 0; i < probe_trail_.size(); i++)
+                probe_implied_[lit_var(probe_trail_[i])] = (signed char)UNASSIGNED;
+        }
+        for (int i = 0; i < probe_units_.size() && st_.ok; i++) {
+            int val = st_.value(probe_units_[i]);
+            if (val == FALSE) st_.ok = FALSE;
+            else if (val == UNASSIGNED) st_.assign(probe_units_[i], CREF_NONE);
+        }
+        if (st_.ok && propagate() != CREF_NONE) st_.ok = FALSE;
+    }
+
+    // =========== 等价文字替换 ===========
+    // 两个文字都没赋值的二元子句组成蕴含图, 每个强连通分量只留代表,
+    // 其它变量在所有子句里换成代表, 之后不再出现. 这些变量的取值按扩展栈里的两个二元子句补上;
+    // 以后加进来的子句和假设也先换成代表
+    void substitute_equivalences(InprocessStats& is)
+    {
+        sub_bins_.clear();
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (c.deleted || c.size != 2) continue;
+            if (st_.value(c.lits[0]) != UNASSIGNED || st_.value(c.lits[1]) != UNASSIGNED) continue;
+            sub_bins_.push(c.lits[0]);
+            sub_bins_.push(c.lits[1]);
+        }
+        if (sub_bins_.size() == 0) return;
+        if (!find_equivalences(st_.num_vars, sub_bins_, sub_repr_)) {
+            st_.ok = FALSE;
+            return;
+        }
+        int found = 0;
+        for (Variable v = 1; v <= st_.num_vars; v++) {
+            if (sub_repr_[v] == v) continue;
+            Literal r = sub_repr_[v];
+            subst_[v] = r;
+            Literal pos[2] = { v, -r }, neg[2] = { -v, r };
+            push_extension(pos, 2, v);
+            push_extension(neg, 2, -v);
+            found++;
+        }
+        if (found == 0) return;
+        num_substituted_ += found;
+        if (Stats::counters) is.variables += found;
+
+        int n = st_.clauses.size();
+        for (int i = 0; i < n && st_.ok; i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (c.deleted) continue;
+            int touched = FALSE;
+            for (int k = 0; k < c.size && !touched; k++) touched = subst_[lit_var(c.lits[k])] != 0;
+            if (!touched) continue;
+
+            add_tmp_.clear();
+            int satisfied = FALSE;
+            for (int k = 0; k < c.size && !satisfied; k++) {
+                Literal l = representative(c.lits[k]);
+                char mark = (char)(l > 0 ? 1 : 2);
+                char seen = st_.seen[lit_var(l)];
+                if (st_.value(l) == TRUE || (seen != 0 && seen != mark)) satisfied = TRUE;
+                else if (st_.value(l) == UNASSIGNED && seen == 0) {
+                    st_.seen[lit_var(l)] = mark;
+                    add_tmp_.push(l);
+                }
+            }
+            for (int k = 0; k < add_tmp_.size(); k++) st_.seen[lit_var(add_tmp_[k])] = 0;
+            if (satisfied) {
+                remove_subsumed(i);
+                if (Stats::counters) is.clauses++;
+            } else {
+                replace_clause(i);
+            }
+        }
+        TRACE_COUNTER("substituted variables", found);
+    }
+
+    // =========== 学习子句的包含检查 ===========
+    // 学习子句从短到长当C, 在全部子句的出现表里找被C包含的子句删掉,
+    // 只差一个相反文字的就去掉那个文字(自包含resolution). 学习子句包含了原始子句时,
+    // 学习子句转成原始子句, reduce_db 不会再删它
+    void subsume_learnts(long long budget, InprocessStats& is)
+    {
+        sub_occ_.grow_to(2 * st_.num_vars + 2);
+        for (int i = 0; i < sub_occ_.size(); i++) sub_occ_[i].clear();
+        sub_sig_.clear();
+        cand_.clear();
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            unsigned long long sig = 0;
+            if (!c.deleted) {
+                for (int k = 0; k < c.size; k++) {
+                    sig |= lit_signature(c.lits[k]);
+                    sub_occ_[lit_index(c.lits[k])].push(i);
+                }
+                if (c.learnt) {
+                    InprocessCandidate ic = { i, c.size };
+                    cand_.push(ic);
+                }
+            }
+            sub_sig_.push(sig);
+        }
+        sort_candidates();
+
+        for (int qi = 0; qi < cand_.size() && budget > 0 && st_.ok; qi++) {
+            int c = cand_[qi].item;
+            if (st_.clauses[c].deleted) continue;
+            int size = st_.clauses[c].size;
+            Variable best = 0;
+            int best_occ = 0;
+            for (int k = 0; k < size; k++) {
+                Literal l = st_.clauses[c].lits[k];
+                int occ = sub_occ_[lit_index(l)].size() + sub_occ_[lit_index(-l)].size();
+                if (best == 0 || occ < best_occ) {
+                    best = lit_var(l);
+                    best_occ = occ;
+                }
+                st_.seen[lit_var(l)] = (char)(l > 0 ? 1 : 2);
+            }
+            budget -= size;
+
+            for (int side = 0; side < 2 && budget > 0; side++) {
+                // 缩短出来的新子句会追加到出现表后面, 这里只看开始时的那些
+                int count = sub_occ_[lit_index(side ? -best : best)].size();
+                for (int i = 0; i < count && st_.ok; i++) {
+                    int d = sub_occ_[lit_index(side ? -best : best)][i];
+                    const CoreClause& dc = st_.clauses[d];
+                    if (d == c || dc.deleted || dc.size < size || (sub_sig_[c] & ~sub_sig_[d])) continue;
+                    budget -= dc.size;
+                    int same = 0, flips = 0;
+                    Literal flip = 0;
+                    for (int k = 0; k < dc.size && flips < 2; k++) {
+                        Literal l = dc.lits[k];
+                        char mark = st_.seen[lit_var(l)];
+                        if (mark == 0) continue;
+                        if (mark == (l > 0 ? 1 : 2)) same++;
+                        else {
+                            flip = l;
+                            flips++;
+                        }
+                    }
+                    if (same == size) {
+                        if (st_.is_locked(d)) continue;
+                        if (!dc.learnt && st_.clauses[c].learnt) {
+                            st_.clauses[c].learnt = 0;
+                            st_.num_learnts--;
+                            st_.num_originals++;
+                        }
+                        remove_subsumed(d);
+                        if (Stats::counters) is.clauses++;
+                    } else if (flips == 1 && same == size - 1) {
+                        if (st_.is_locked(d)) continue;
+                        strengthen_clause(d, flip);
+                        if (Stats::counters) is.literals++;
+                    }
+                }
+            }
+            const CoreClause& cc = st_.clauses[c];
+            for (int k = 0; k < cc.size; k++) st_.seen[lit_var(cc.lits[k])] = 0;
+        }
+    }
+
+    // 子句去掉 flip 文字(和第0层为假的文字), 第0层已满足的不动
+    void strengthen_clause(int cref, Literal flip)
+    {
+        add_tmp_.clear();
+        const CoreClause& d = st_.clauses[cref];
+        for (int k = 0; k < d.size; k++) {
+            Literal l = d.lits[k];
+            int val = st_.value(l);
+            if (val == TRUE) return;
+            if (l != flip && val == UNASSIGNED) add_tmp_.push(l);
+        }
+        int fresh = replace_clause(cref);
+        if (fresh == CREF_NONE) return;
+        const CoreClause& c = st_.clauses[fresh];
+        unsigned long long sig = 0;
+        for (int k = 0; k < c.size; k++) {
+            sig |= lit_signature(c.lits[k]);
+            sub_occ_[lit_index(c.lits[k])].push(fresh);
+        }
+        sub_sig_.grow_to(fresh + 1, 0);
+        sub_sig_[fresh] = sig;
+    }
+
+    // =========== 学习子句活化 ===========
+    // 一层一层地假设子句的文字为假并传播, 子句自己不算:
+    //   某个文字已经为假 -> 它可以去掉
+    //   某个文字已经为真, 或者传播出矛盾 -> 子句缩短成假设过的文字(加上为真的那个)
+    // 子句自己变成单元传播了的话, 这一步的结论都不能用, 剩下的文字原样留着.
+    // LBD小的先做, 做过的打上标记以后不再做
+    void vivify_learnts(long long budget, InprocessStats& is)
+    {
+        cand_.clear();
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (c.deleted || !c.learnt || c.vivified) continue;
+            InprocessCandidate ic = { i, c.lbd };
+            cand_.push(ic);
+        }
+        sort_candidates();
+        long long stop = st_.stats.propagations + budget;
+        for (int i = 0; i < cand_.size() && st_.ok && st_.stats.propagations < stop; i++) {
+            int cref = cand_[i].item;
+            st_.clauses[cref].vivified = 1;
+            if (Stats::counters) st_.stats.vivified_clauses++;
+            vivify_clause(cref, is);
+        }
+    }
+
+    void vivify_clause(int cref, InprocessStats& is)
+    {
+        // 下面开层传播时子句数组不会搬家, 但新子句要等退回第0层以后再建
+        const CoreClause& c = st_.clauses[cref];
+        viv_lits_.clear();
+        for (int k = 0; k < c.size; k++) {
+            int val = st_.value(c.lits[k]);
+            if (val == TRUE) return;
+            if (val == UNASSIGNED) viv_lits_.push(c.lits[k]);
+        }
+        add_tmp_.clear();
+        for (int i = 0; i < viv_lits_.size(); i++) {
+            Literal l = viv_lits_[i];
+            int val = st_.value(l);
+            if (val == FALSE) continue;
+            add_tmp_.push(l);
+            if (val == TRUE) break;
+            int step = st_.trail.size();
+            st_.trail_lim.push(step);
+            st_.assign(-l, CREF_NONE);
+            int confl = propagate();
+            int tainted = FALSE;
+            for (int t = step + 1; t < st_.trail.size() && !tainted; t++)
+                tainted = st_.reason[lit_var(st_.trail[t])] == cref;
+            if (tainted) {
+                for (int k = i + 1; k < viv_lits_.size(); k++) add_tmp_.push(viv_lits_[k]);
+                break;
+            }
+            if (confl != CREF_NONE) break;
+        }
+        backtrack(0);
+        int removed = st_.clauses[cref].size - add_tmp_.size();
+        if (removed <= 0) return;
+        if (Stats::counters) is.literals += removed;
+        replace_clause(cref);
+    }
+
+    // =========== 有界变量消去 ===========
+    // 原始子句里出现得少的变量, 含它的原始子句全部换成两两之间的resolvent, 子句数不增加才做.
+    // 换掉的子句按见证文字存进扩展栈, save_model 倒着补值; 含它的学习子句直接删掉.
+    // 以后的假设或者新加的子句又用到这个变量时, 存的子句原样加回来(restore_variable).
+    // 本次 solve 的假设变量不消
+    void eliminate_variables(long long budget, InprocessStats& is)
+    {
+        sub_occ_.grow_to(2 * st_.num_vars + 2);
+        for (int i = 0; i < sub_occ_.size(); i++) sub_occ_[i].clear();
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (c.deleted || c.learnt || clause_satisfied(c)) continue;
+            for (int k = 0; k < c.size; k++)
+                if (st_.value(c.lits[k]) == UNASSIGNED) sub_occ_[lit_index(c.lits[k])].push(i);
+        }
+        for (int i = 0; i < assumptions_.size(); i++) st_.seen[lit_var(assumptions_[i])] = 1;
+        cand_.clear();
+        for (Variable v = 1; v <= st_.num_vars; v++) {
+            if (st_.value(v) != UNASSIGNED || eliminated_[v] || subst_[v] != 0 || st_.seen[v]) continue;
+            int pos = sub_occ_[lit_index(v)].size(), neg = sub_occ_[lit_index(-v)].size();
+            if (pos + neg == 0 || pos + neg > INPROCESS_ELIM_OCC) continue;
+            InprocessCandidate ic = { v, pos * neg };
+            cand_.push(ic);
+        }
+        for (int i = 0; i < assumptions_.size(); i++) st_.seen[lit_var(assumptions_[i])] = 0;
+        sort_candidates();
+
+        int before = num_eliminated_;
+        for (int i = 0; i < cand_.size() && st_.ok && budget > 0; i++)
+            try_eliminate(cand_[i].item, &budget, is);
+        if (num_eliminated_ == before) return;
+
+        for (int i = 0; i < st_.clauses.size(); i++) {
+            const CoreClause& c = st_.clauses[i];
+            if (c.deleted) continue;
+            int stale = FALSE;
+            for (int k = 0; k < c.size && !stale; k++) stale = eliminated_[lit_var(c.lits[k])];
+            if (stale) remove_subsumed(i);
+        }
+        TRACE_COUNTER("eliminated variables", num_eliminated_);
+    }
+
+    int clause_satisfied(const CoreClause& c) const
+    {
+        for (int k = 0; k < c.size; k++)
+            if (st_.value(c.lits[k]) == TRUE) return TRUE;
+        return FALSE;
+    }
+
+    // 出现表里删掉的挤掉, 剩下的放进 out
+    void live_occurrences(Literal lit, Vec<int>& out)
+    {
+        Vec<int>& occ = sub_occ_[lit_index(lit)];
+        int j = 0;
+        for (int i = 0; i < occ.size(); i++)
+            if (!st_.clauses[occ[i]].deleted) occ[j++] = occ[i];
+        occ.shrink(j);
+        occ.copy_to(out);
+    }
+
+    // 子句 a(含v) 和 b(含-v) 的resolvent放进 add_tmp_, 去掉第0层为假的文字;
+    // 重言式或者已满足时返回FALSE
+    int resolve(int a, int b, Variable v)
+    {
+        add_tmp_.clear();
+        int keep = TRUE;
+        for (int side = 0; side < 2 && keep; side++) {
+            const CoreClause& c = st_.clauses[side ? b : a];
+            for (int k = 0; k < c.size && keep; k++) {
+                Literal l = c.lits[k];
+                if (lit_var(l) == v) continue;
+                char mark = (char)(l > 0 ? 1 : 2);
+                char seen = st_.seen[lit_var(l)];
+                if (st_.value(l) == TRUE || (seen != 0 && seen != mark)) keep = FALSE;
+                else if (st_.value(l) == UNASSIGNED && seen == 0) {
+                    st_.seen[lit_var(l)] = mark;
+                    add_tmp_.push(l);
+                }
+            }
+        }
+        for (int k = 0; k < add_tmp_.size(); k++) st_.seen[lit_var(add_tmp_[k])] = 0;
+        return keep;
+    }
+
+    void try_eliminate(Variable v, long long* budget, InprocessStats& is)
+    {
+        live_occurrences(v, elim_pos_);
+        live_occurrences(-v, elim_neg_);
+        int limit = elim_pos_.size() + elim_neg_.size(), resolvents = 0;
+        if (limit == 0) return;
+        for (int i = 0; i < elim_pos_.size(); i++) {
+            for (int j = 0; j < elim_neg_.size(); j++) {
+                *budget -= st_.clauses[elim_pos_[i]].size + st_.clauses[elim_neg_[j]].size;
+                if (!resolve(elim_pos_[i], elim_neg_[j], v)) continue;
+                if (++resolvents > limit || add_tmp_.size() > INPROCESS_ELIM_RESOLVENT) return;
+            }
+        }
+
+        for (int side = 0; side < 2; side++) {
+            const Vec<int>& list = side ? elim_neg_ : elim_pos_;
+            for (int i = 0; i < list.size(); i++) {
+                const CoreClause& c = st_.clauses[list[i]];
+                push_extension(c.lits, c.size, side ? -v : v);
+            }
+        }
+        for (int i = 0; i < elim_pos_.size() && st_.ok; i++) {
+            for (int j = 0; j < elim_neg_.size() && st_.ok; j++) {
+                if (!resolve(elim_pos_[i], elim_neg_[j], v)) continue;
+                if (add_tmp_.size() == 0) st_.ok = FALSE;
+                else if (add_tmp_.size() == 1) sub_units_.push(add_tmp_[0]);
+                else {
+                    int cref = st_.alloc_clause(add_tmp_.data(), add_tmp_.size(), FALSE);
+                    prop_.attach(st_, cref);
+                    heur_.on_clause(st_, add_tmp_.data(), add_tmp_.size());
+                    for (int k = 0; k < add_tmp_.size(); k++) sub_occ_[lit_index(add_tmp_[k])].push(cref);
+                }
+            }
+        }
+        for (int i = 0; i < elim_pos_.size(); i++) remove_subsumed(elim_pos_[i]);
+        for (int i = 0; i < elim_neg_.size(); i++) remove_subsumed(elim_neg_[i]);
+        eliminated_[v] = 1;
+        num_eliminated_++;
+        if (Stats::counters) {
+            is.variables++;
+            is.clauses += limit - resolvents;
+        }
+    }
+
+    // =========== 扩展栈 ===========
+    // 等价替换和变量消去拿掉的子句, 每项第一个文字是见证文字.
+    // 倒着补模型时某项不满足就把见证文字设成真
+    void push_extension(const Literal* lits, int size, Literal witness)
+    {
+        elim_starts_.push(elim_lits_.size());
+        elim_lits_.push(witness);
+        for (int k = 0; k < size; k++)
+            if (lits[k] != witness) elim_lits_.push(lits[k]);
+    }
+
+    int extension_end(int e) const { return e + 1 < elim_starts_.size() ? elim_starts_[e + 1] : elim_lits_.size(); }
+
+    // 被消掉的变量又被假设或者新子句用到: 扩展栈里它的子句原样加回去,
+    // 里面别的被消掉的变量在 add_clause_impl 里同样恢复
+    void restore_variable(Variable v)
+    {
+        eliminated_[v] = 0;
+        num_eliminated_--;
+        Vec<Literal> back;  // 长度在前; 加回子句时可能递归恢复, 不能用成员数组
+        int n = elim_starts_.size(), w = 0, lw = 0;
+        for (int e = 0; e < n; e++) {
+            int b = elim_starts_[e], end = extension_end(e);
+            if (lit_var(elim_lits_[b]) == v) {
+                back.push(end - b);
+                for (int k = b; k < end; k++) back.push(elim_lits_[k]);
+                continue;
+            }
+            elim_starts_[w++] = lw;
+            for (int k = b; k < end; k++) elim_lits_[lw++] = elim_lits_[k];
+        }
+        elim_starts_.shrink(w);
+        elim_lits_.shrink(lw);
+        for (int i = 0; i < back.size() && st_.ok; i += back[i] + 1) add_clause_impl(back.data() + i + 1, back[i], FALSE);
+    }
+
+    void save_model()
+    {
+        st_.model.clear();
+        st_.model.grow_to(st_.num_vars + 1, (signed char)FALSE);
+        for (Variable v = 1; v <= st_.num_vars; v++)
+            st_.model[v] = (signed char)(st_.value(v) == TRUE ? TRUE : FALSE);
+        for (int e = elim_starts_.size() - 1; e >= 0; e--) {
+            int b = elim_starts_[e], end = extension_end(e);
+            int satisfied = FALSE;
+            for (int k = b; k < end && !satisfied; k++)
+                satisfied = st_.model[lit_var(elim_lits_[k])] == (elim_lits_[k] > 0 ? TRUE : FALSE);
+            if (!satisfied) st_.model[lit_var(elim_lits_[b])] = (signed char)(elim_lits_[b] > 0 ? TRUE : FALSE);
+        }
+    }
+
+    // 搜索到出结果或者需要重启为止, 重启时返回UNKNOWN
+    SatResult search()
+    {
+        for (;;) {
+            int confl = propagate();
+            if (confl != CREF_NONE) {
+                // 冲突/决策/传播数是预算, 重启和内处理调度要用的, 各个统计级别都计
+                st_.stats.conflicts++;
+                if (st_.decision_level() == 0) {
+                    st_.ok = FALSE;
+                    return UNSAT;
+                }
+
+                int btlevel, lbd;
+                analyze(confl, &btlevel, &lbd);
+                if (Stats::full)
+                    printf("[trace] conflict at level %d, learnt size %d lbd %d, backjump to %d\n",
+                           st_.decision_level(), learnt_.size(), lbd, btlevel);
+                backtrack(btlevel);
+
+                if (learnt_.size() == 1) {
+                    st_.assign(learnt_[0], CREF_NONE);
+                } else {
+                    int cref = st_.alloc_clause(learnt_.data(), learnt_.size(), TRUE);
+                    st_.clauses[cref].lbd = lbd;
+                    bump_clause(st_.clauses[cref]);
+                    prop_.attach(st_, cref);
+                    heur_.on_clause(st_, learnt_.data(), learnt_.size());
+                    st_.assign(learnt_[0], cref);
+                }
+                if (Stats::counters) {
+                    st_.stats.learned_clauses++;
+                    st_.stats.learned_literals += learnt_.size();
+                }
+
+                heur_.decay();
+                st_.clause_inc *= (1.0 / 0.999);
+                restart_.on_conflict(lbd);
+                if (exchange_) export_learnt(lbd);
+
+                // 超过内存上限: 先清掉学习子句, 还不够就放弃
+                if (mem_over_limit(&mem_)) {
+                    reduce_db(TRUE);
+                    if (mem_over_limit(&mem_)) {
+                        st_.stats.stop_reason = STOP_MEMORY;
+                        backtrack(0);
+                        return UNKNOWN;
+                    }
+                }
+                if (out_of_budget()) {
+                    if (!slice_) backtrack(0);
+                    return UNKNOWN;
+                }
+            } else {
+                if (restart_.should_restart()) {
+                    TRACE_COUNTER("trail size", st_.trail.size());
+                    TRACE_COUNTER("learned clauses", st_.num_learnts);
+                    backtrack(0);
+                    return UNKNOWN;
+                }
+                if (out_of_budget()) {
+                    if (!slice_) backtrack(0);
+                    return UNKNOWN;
+                }
+                if (st_.stats.conflicts >= next_reduce_) {
+                    next_reduce_ = st_.stats.conflicts + reduce_inc_;
+                    reduce_inc_ += 300;
+                    reduce_db(FALSE);
+                }
+
+                // 先把假设一层一层地当作决策, 已经为真的也占一层, 层号和假设下标对齐
+                Literal next = 0;
+                while (st_.decision_level() < assumptions_.size()) {
+                    Literal a = assumptions_[st_.decision_level()];
+                    int val = st_.value(a);
+                    if (val == TRUE) {
+                        st_.trail_lim.push(st_.trail.size());
+                    } else if (val == FALSE) {
+                        analyze_final(a);
+                        backtrack(0);
+                        return UNSAT;
+                    } else {
+                        next = a;
+                        break;
+                    }
+                }
+                if (next == 0) next = heur_.pick(st_);
+                if (next == 0) {
+                    save_model();
+                    return SAT;
+                }
+                st_.stats.decisions++;
+                st_.trail_lim.push(st_.trail.size());
+                if (Stats::counters && st_.decision_level() > st_.stats.max_level)
+                    st_.stats.max_level = st_.decision_level();
+                if (Stats::full) printf("[trace] decide %d at level %d\n", next, st_.decision_level());
+                st_.assign(next, CREF_NONE);
+            }
+        }
+    }
+
+    SolverConfig config_;
+    MemTracker mem_;                    // 必须在st_等之前声明, 析构时最后一个销毁
+    int broken_;                        // 分配失败过
+    std::atomic<int> interrupted_;      // interrupt() 设置, solve 返回时清掉
+    double deadline_;                   // 本次solve的预算, 0表示不限
+    long long conflict_stop_;
+    long long decision_stop_;
+    long long propagation_stop_;
+    unsigned int limit_tick_;
+    long long slice_;                   // resume 这一段的传播数, 0表示普通的solve
+    double next_progress_;              // 下一次进度回调的时间, 0表示没有回调
+    SolverBudget* budget_;              // 共用预算, NULL表示按 config_ 每次solve算
+    long long charged_conflicts_;       // 已经加到 budget_ 上的计数
+    long long charged_decisions_;
+    long long charged_propagations_;
+    ClauseExchange* exchange_;          // 子句交换, NULL表示不交换
+    int exchange_id_;
+    unsigned long long exchange_cursor_;
+    long long share_credit_;            // 还能导出的文字数
+    SearchState st_;
+    Heuristic heur_;
+    Propagation prop_;
+    Restart restart_;
+
+    Vec<Literal> assumptions_;          // 本次solve的假设
+    Vec<Literal> failed_;               // UNSAT时失败的假设
+    Vec<Literal> learnt_;               // 冲突分析结果
+    Vec<Literal> analyze_stack_;        // 最小化时递归用的栈
+    Vec<Literal> analyze_clear_;        // 冲突分析之后要清掉 seen 标记的文字
+    Vec<Literal> add_tmp_;              // add_clause 的临时数组
+    Vec<ReduceCandidate> reduce_tmp_;
+    Vec<int> lbd_stamp_;                // 算LBD用的层标记
+    long long next_reduce_;
+    long long reduce_inc_;
+    long long next_inprocess_;          // 下一轮搜索中化简的冲突数
+    long long inprocess_propagations_;  // 上一轮结束时的传播次数
+    int num_substituted_;
+    int num_eliminated_;
+    Vec<Literal> subst_;                // 按变量: 被替换成的代表文字(对应正文字), 0表示没有
+    Vec<char> eliminated_;              // 按变量: 被消去了
+    Vec<Literal> elim_lits_;            // 扩展栈的文字, 见 push_extension
+    Vec<int> elim_starts_;              // 扩展栈每一项的起点
+    Vec<InprocessCandidate> cand_;
+    Vec<Literal> sub_bins_;             // 等价替换时收集的二元子句
+    Vec<Literal> sub_repr_;
+    Vec<Vec<int>, MEM_WATCHES> sub_occ_;    // 包含检查和消去用的出现表, 按lit_index
+    Vec<unsigned long long> sub_sig_;   // 按cref
+    Vec<int> sub_removed_;              // 这一遍删掉的cref, 最后统一释放
+    Vec<Literal> sub_units_;            // 这一遍缩短出来的单元
+    Vec<int> elim_pos_;                 // 正在消去的变量的正/负出现
+    Vec<int> elim_neg_;
+    Vec<Literal> viv_lits_;             // 正在活化的子句
+    Vec<int> probe_bins_;               // 按lit_index: 含这个文字的二元子句数
+    Vec<signed char> probe_implied_;    // 按变量: 正极性试探推出的值
+    Vec<Literal> probe_trail_;
+    Vec<Literal> probe_units_;
+    int probe_cursor_;                  // 下一轮探测从候选的这个位置开始
+    int lbd_stamp_counter_;
+};
+
+#endif // SEARCH_ENGINE_H
@@ -0,0 +1,442 @@
+#ifndef SEARCH_POLICIES_H
+#define SEARCH_POLICIES_H
+
+#include "search_state.h"
+#include <math.h>
+
+// =========== 搜索策略 ===========
+// SearchEngine 的四个模板参数: 决策启发式, 传播方式, 重启策略, 统计级别
+// 每个策略只需要提供下面用到的那几个成员函数, 空函数会被内联掉
+
+// ---------- 变量堆(按分数取最大) ----------
+class VarHeap {
+public:
+    VarHeap() : keys_(NULL) {}
+
+    void set_keys(const Vec<double, MEM_HEURISTIC>* keys) { keys_ = keys; }
+    int empty() const { return heap_.size() == 0; }
+    int contains(Variable v) const { return v < index_.size() && index_[v] >= 0; }
+
+    void grow_to(int n) { index_.grow_to(n + 1, -1); }
+
+    void insert(Variable v)
+    {
+        index_[v] = heap_.size();
+        heap_.push(v);
+        percolate_up(index_[v]);
+    }
+
+    // 分数变大后调整位置
+    void increase(Variable v)
+    {
+        if (contains(v)) percolate_up(index_[v]);
+    }
+
+    Variable pop_max()
+    {
+        Variable top = heap_[0];
+        heap_[0] = heap_.last();
+        index_[heap_[0]] = 0;
+        index_[top] = -1;
+        heap_.pop();
+        if (heap_.size() > 1) percolate_down(0);
+        return top;
+    }
+
+private:
+    double key(Variable v) const { return (*keys_)[v]; }
+
+    void percolate_up(int i)
+    {
+        Variable v = heap_[i];
+        while (i > 0) {
+            int parent = (i - 1) >> 1;
+            if (key(heap_[parent]) >= key(v)) break;
+            heap_[i] = heap_[parent];
+            index_[heap_[i]] = i;
+            i = parent;
+        }
+        heap_[i] = v;
+        index_[v] = i;
+    }
+
+    void percolate_down(int i)
+    {
+        Variable v = heap_[i];
+        int n = heap_.size();
+        while (2 * i + 1 < n) {
+            int child = 2 * i + 1;
+            if (child + 1 < n && key(heap_[child + 1]) > key(heap_[child])) child++;
+            if (key(heap_[child]) <= key(v)) break;
+            heap_[i] = heap_[child];
+            index_[heap_[i]] = i;
+            i = child;
+        }
+        heap_[i] = v;
+        index_[v] = i;
+    }
+
+    const Vec<double, MEM_HEURISTIC>* keys_;
+    Vec<int, MEM_HEURISTIC> heap_;
+    Vec<int, MEM_HEURISTIC> index_;    // 变量在堆里的位置, -1表示不在堆里
+};
+
+// ---------- 决策启发式: VSIDS ----------
+// 冲突分析里碰到的变量加分, 分数按指数衰减, 相位用上次的取值
+struct VsidsHeuristic {
+    Vec<double, MEM_HEURISTIC> activity;
+    double var_inc;
+    int randomize;
+    VarHeap heap;
+
+    VsidsHeuristic() : var_inc(1.0), randomize(FALSE) { heap.set_keys(&activity); }
+
+    void init(SearchState&, const SolverConfig& config) { randomize = config.seed != 0; }
+
+    void grow_vars(SearchState& st)
+    {
+        int old = activity.size() > 0 ? activity.size() - 1 : 0;
+        activity.grow_to(st.num_vars + 1, 0.0);
+        heap.grow_to(st.num_vars);
+        for (Variable v = old + 1; v <= st.num_vars; v++) {
+            // 给了种子就加一点扰动, portfolio里不同线程的初始顺序就不一样了
+            if (randomize) activity[v] = (st.next_random() % 1000) * 1e-5;
+            heap.insert(v);
+        }
+    }
+
+    void on_clause(SearchState&, const Literal*, int) {}
+
+    void bump(Variable v)
+    {
+        if ((activity[v] += var_inc) > 1e100) {
+            for (int i = 1; i < activity.size(); i++) activity[i] *= 1e-100;
+            var_inc *= 1e-100;
+        }
+        heap.increase(v);
+    }
+
+    void decay() { var_inc *= (1.0 / 0.95); }
+
+    void on_unassign(Variable v)
+    {
+        if (!heap.contains(v)) heap.insert(v);
+    }
+
+    Literal pick(SearchState& st)
+    {
+        while (!heap.empty()) {
+            Variable v = heap.pop_max();
+            if (st.lit_val[2 * v] == UNASSIGNED) return st.polarity[v] == TRUE ? v : -v;
+        }
+        return 0;
+    }
+};
+
+// ---------- 决策启发式: Jeroslow-Wang ----------
+// 每个子句给其中的文字加 2^-|C|, 变量按正负权重之和排序, 相位取权重大的一边
+// 学到的子句同样累加, 所以顺序会随着搜索慢慢变化
+struct JwHeuristic {
+    Vec<double, MEM_HEURISTIC> pos_weight;
+    Vec<double, MEM_HEURISTIC> neg_weight;
+    Vec<double, MEM_HEURISTIC> score;
+    VarHeap heap;
+
+    JwHeuristic() { heap.set_keys(&score); }
+
+    void init(SearchState&, const SolverConfig&) {}
+
+    void grow_vars(SearchState& st)
+    {
+        int old = score.size() > 0 ? score.size() - 1 : 0;
+        pos_weight.grow_to(st.num_vars + 1, 0.0);
+        neg_weight.grow_to(st.num_vars + 1, 0.0);
+        score.grow_to(st.num_vars + 1, 0.0);
+        heap.grow_to(st.num_vars);
+        for (Variable v = old + 1; v <= st.num_vars; v++) heap.insert(v);
+    }
+
+    void on_clause(SearchState&, const Literal* lits, int size)
+    {
+        double weight = ldexp(1.0, -size);
+        for (int i = 0; i < size; i++) {
+            Variable v = lit_var(lits[i]);
+            if (lits[i] > 0) pos_weight[v] += weight;
+            else neg_weight[v] += weight;
+            score[v] += weight;
+            heap.increase(v);
+        }
+    }
+
+    void bump(Variable) {}
+    void decay() {}
+
+    void on_unassign(Variable v)
+    {
+        if (!heap.contains(v)) heap.insert(v);
+    }
+
+    Literal pick(SearchState& st)
+    {
+        while (!heap.empty()) {
+            Variable v = heap.pop_max();
+            if (st.lit_val[2 * v] == UNASSIGNED) return pos_weight[v] >= neg_weight[v] ? v : -v;
+        }
+        return 0;
+    }
+};
+
+// ---------- 传播: 双文字监视 ----------
+// watches[lit_index(l)] 里是监视着l的子句, l变假时检查
+struct WatchedPropagation {
+    Vec<Vec<Watcher, MEM_WATCHES>, MEM_WATCHES> watches;
+
+    void grow_vars(SearchState& st) { watches.grow_to(2 * st.num_vars + 2); }
+
+    // 子句的 watch[0], watch[1] 已经由调用者选好
+    void attach(SearchState& st, int cref)
+    {
+        const CoreClause& c = st.clauses[cref];
+        Watcher w0 = { cref, c.watch[1] };
+        Watcher w1 = { cref, c.watch[0] };
+        watches[lit_index(c.watch[0])].push(w0);
+        watches[lit_index(c.watch[1])].push(w1);
+    }
+
+    // 把标记为deleted的子句从监视表里摘掉
+    void purge(SearchState& st)
+    {
+        for (int i = 0; i < watches.size(); i++) {
+            Vec<Watcher, MEM_WATCHES>& ws = watches[i];
+            int j = 0;
+            for (int k = 0; k < ws.size(); k++)
+                if (!st.clauses[ws[k].cref].deleted) ws[j++] = ws[k];
+            ws.shrink(j);
+        }
+    }
+
+    void on_unassign(SearchState&, Literal) {}
+
+    // 返回冲突子句, 没有冲突返回CREF_NONE
+    int propagate(SearchState& st)
+    {
+        int confl = CREF_NONE;
+        while (st.qhead < st.trail.size() && confl == CREF_NONE) {
+            Literal p = st.trail[st.qhead++];
+            Literal false_lit = -p;
+            Vec<Watcher, MEM_WATCHES>& ws = watches[lit_index(false_lit)];
+            Watcher* i = ws.data();
+            Watcher* j = i;
+            Watcher* end = i + ws.size();
+
+            while (i != end) {
+                // blocker为真, 子句已满足
+                if (st.value(i->blocker) == TRUE) {
+                    *j++ = *i++;
+                    continue;
+                }
+                int cref = i->cref;
+                CoreClause& c = st.clauses[cref];
+                Literal other = c.watch[0] == false_lit ? c.watch[1] : c.watch[0];
+                if (other != i->blocker && st.value(other) == TRUE) {
+                    j->cref = cref;
+                    j->blocker = other;
+                    j++;
+                    i++;
+                    continue;
+                }
+
+                // 找一个不为假的文字换过去
+                Literal replacement = 0;
+                for (int k = 0; k < c.size; k++) {
+                    Literal l = c.lits[k];
+                    if (l != false_lit && l != other && st.value(l) != FALSE) {
+                        replacement = l;
+                        break;
+                    }
+                }
+                if (replacement != 0) {
+                    if (c.watch[0] == false_lit) c.watch[0] = replacement;
+                    else c.watch[1] = replacement;
+                    Watcher w = { cref, other };
+                    watches[lit_index(replacement)].push(w);
+                    i++;
+                    continue;
+                }
+
+                // 子句是单元或者冲突
+                *j++ = *i++;
+                if (st.value(other) == FALSE) {
+                    confl = cref;
+                    while (i != end) *j++ = *i++;
+                } else {
+                    st.assign(other, cref);
+                }
+            }
+            ws.shrink((int)(j - ws.data()));
+        }
+        return confl;
+    }
+};
+
+// ---------- 传播: 出现表 + 计数 ----------
+// 每个子句记录已处理的真/假文字个数, 假文字数到 size-1 时检查是否为单元
+// 回溯时要把已处理的文字撤销掉, 所以需要 on_unassign
+struct CountingPropagation {
+    Vec<Vec<int, MEM_WATCHES>, MEM_WATCHES> occurs;  // 按lit_index: 含有该文字的子句
+    Vec<int, MEM_WATCHES> true_count;               // 按cref
+    Vec<int, MEM_WATCHES> false_count;
+
+    void grow_vars(SearchState& st) { occurs.grow_to(2 * st.num_vars + 2); }
+
+    // 要求此时所有已赋值文字都已经处理过(qhead == trail.size())
+    void attach(SearchState& st, int cref)
+    {
+        const CoreClause& c = st.clauses[cref];
+        true_count.grow_to(st.clauses.size(), 0);
+        false_count.grow_to(st.clauses.size(), 0);
+        int t = 0, f = 0;
+        for (int k = 0; k < c.size; k++) {
+            int v = st.value(c.lits[k]);
+            if (v == TRUE) t++;
+            else if (v == FALSE) f++;
+            occurs[lit_index(c.lits[k])].push(cref);
+        }
+        true_count[cref] = t;
+        false_count[cref] = f;
+    }
+
+    void purge(SearchState& st)
+    {
+        for (int i = 0; i < occurs.size(); i++) {
+            Vec<int, MEM_WATCHES>& os = occurs[i];
+            int j = 0;
+            for (int k = 0; k < os.size(); k++)
+                if (!st.clauses[os[k]].deleted) os[j++] = os[k];
+            os.shrink(j);
+        }
+    }
+
+    void on_unassign(SearchState&, Literal p)
+    {
+        Vec<int, MEM_WATCHES>& sat = occurs[lit_index(p)];
+        for (int k = 0; k < sat.size(); k++) true_count[sat[k]]--;
+        Vec<int, MEM_WATCHES>& fal = occurs[lit_index(-p)];
+        for (int k = 0; k < fal.size(); k++) false_count[fal[k]]--;
+    }
+
+    int propagate(SearchState& st)
+    {
+        int confl = CREF_NONE;
+        while (st.qhead < st.trail.size() && confl == CREF_NONE) {
+            Literal p = st.trail[st.qhead++];
+
+            Vec<int, MEM_WATCHES>& sat = occurs[lit_index(p)];
+            for (int k = 0; k < sat.size(); k++) true_count[sat[k]]++;
+
+            // 冲突之后也要把计数补完, 否则回溯时对不上
+            Vec<int, MEM_WATCHES>& fal = occurs[lit_index(-p)];
+            for (int k = 0; k < fal.size(); k++) {
+                int cref = fal[k];
+                int f = ++false_count[cref];
+                if (confl != CREF_NONE || true_count[cref] > 0) continue;
+                const CoreClause& c = st.clauses[cref];
+                if (f < c.size - 1) continue;
+
+                // 已入队但还没处理的文字只能看当前取值
+                Literal unit = 0;
+                int satisfied = FALSE;
+                for (int m = 0; m < c.size; m++) {
+                    int v = st.value(c.lits[m]);
+                    if (v == TRUE) { satisfied = TRUE; break; }
+                    if (v == UNASSIGNED) unit = c.lits[m];
+                }
+                if (satisfied) continue;
+                if (unit == 0) confl = cref;
+                else st.assign(unit, cref);
+            }
+        }
+        return confl;
+    }
+};
+
+// ---------- 重启策略 ----------
+// Luby序列: 1 1 2 1 1 2 4 1 1 2 ...
+inline double luby(double y, int x)
+{
+    int size = 1, seq = 0;
+    while (size < x + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    return pow(y, seq);
+}
+
+struct LubyRestart {
+    long long conflicts;
+    long long limit;
+    int index;
+
+    void init(const SolverConfig&) { conflicts = 0; index = 0; limit = 100; }
+    void on_conflict(int) { conflicts++; }
+    int should_restart() const { return conflicts >= limit; }
+    void on_restart()
+    {
+        conflicts = 0;
+        index++;
+        limit = (long long)(100 * luby(2.0, index));
+    }
+};
+
+struct GeometricRestart {
+    long long conflicts;
+    double limit;
+
+    void init(const SolverConfig&) { conflicts = 0; limit = 100; }
+    void on_conflict(int) { conflicts++; }
+    int should_restart() const { return conflicts >= (long long)limit; }
+    void on_restart()
+    {
+        conflicts = 0;
+        limit *= 1.5;
+    }
+};
+
+struct NoRestart {
+    void init(const SolverConfig&) {}
+    void on_conflict(int) {}
+    int should_restart() const { return FALSE; }
+    void on_restart() {}
+};
+
+// ---------- 统计级别 ----------
+// 编译期常量, 对应 SAT_STATS_LEVEL; counters 为false时引擎只计预算要用的三个计数
+struct StatsOff {
+    static const bool counters = false;
+    static const bool full = false;
+};
+
+struct StatsCounters {
+    static const bool counters = true;
+    static const bool full = false;
+};
+
+struct StatsFull {
+    static const bool counters = true;
+    static const bool full = true;
+};
+
+#if SAT_STATS_LEVEL >= SAT_STATS_FULL
+typedef StatsFull BuildStats;
+#elif SAT_STATS_LEVEL >= SAT_STATS_COUNTERS
+typedef StatsCounters BuildStats;
+#else
+typedef StatsOff BuildStats;
+#endif
+
+#endif // SEARCH_POLICIES_H
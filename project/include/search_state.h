@@ -0,0 +1,214 @@
+#ifndef SEARCH_STATE_H
+#define SEARCH_STATE_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+#include "vec.h"
+
+// =========== 搜索状态 ===========
+// 和具体策略无关的数据都放在这里, 各个策略类通过 SearchState& 访问
+// 文字在外面仍然是DIMACS的正负整数, 内部数组用 lit_index 下标:
+//   变量v的正文字 -> 2v, 负文字 -> 2v+1
+
+#define CREF_NONE -1    // 没有原因子句(决策或者第0层单元)
+
+inline int lit_index(Literal lit) { return lit > 0 ? 2 * lit : -2 * lit + 1; }
+inline Variable lit_var(Literal lit) { return lit > 0 ? lit : -lit; }
+// 子句签名(按变量的64位Bloom过滤): C的变量是D的子集时 sig(C) & ~sig(D) == 0
+inline unsigned long long lit_signature(Literal lit) { return 1ULL << (lit_var(lit) & 63); }
+
+// 内部子句: 文字数组本身不改动, 监视的两个文字单独记下来
+typedef struct {
+    Literal* lits;          // 文字
+    int size;               // 文字个数
+    Literal watch[2];       // 双文字监视用
+    int lbd;                // 学习子句的LBD(不同决策层的个数)
+    float activity;         // 学习子句活跃度, reduce_db时用
+    unsigned char learnt;   // 是否为学习子句
+    unsigned char deleted;  // 已删除, 槽位等待复用
+    unsigned char shared;   // lits 指向共享的只读子句库, 不归这个求解器释放
+    unsigned char vivified; // 搜索中的活化已经做过
+} CoreClause;
+
+// 监视表项: blocker为真时不用去看子句
+typedef struct {
+    int cref;
+    Literal blocker;
+} Watcher;
+
+struct SearchState {
+    int num_vars;
+    int ok;                         // FALSE: 第0层已经矛盾
+
+    MemTracker* mem;                // 所属求解器的内存记账
+
+    Vec<CoreClause, MEM_CLAUSES> clauses;   // cref 就是下标
+    Vec<int, MEM_CLAUSES> free_crefs;       // 删掉的槽位
+    int num_learnts;                // 当前学习子句数
+    int num_originals;              // 当前原始子句数(不含单元)
+
+    Vec<signed char, MEM_TRAIL> lit_val;    // 按lit_index: TRUE/FALSE/UNASSIGNED
+    Vec<int, MEM_TRAIL> level;              // 变量所在决策层
+    Vec<int, MEM_TRAIL> reason;             // 变量的原因子句
+    Vec<signed char, MEM_TRAIL> polarity;   // 相位保存: 上次的取值
+    Vec<char, MEM_TRAIL> seen;              // 冲突分析用
+
+    Vec<Literal, MEM_TRAIL> trail;          // 赋值顺序
+    Vec<int, MEM_TRAIL> trail_lim;          // 每一层在trail中的起点
+    int qhead;                              // 传播队列头
+
+    Vec<signed char, MEM_TRAIL> model;      // SAT时的模型, 按变量
+    double clause_inc;              // 学习子句活跃度增量
+    unsigned int rng;               // 随机数状态
+    SolverStats stats;
+
+    SearchState() : num_vars(0), ok(TRUE), mem(NULL), num_learnts(0), num_originals(0), qhead(0),
+                    clause_inc(1.0), rng(1)
+    {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    // 在求解器的 MemScope 里调用, 这样内存记到求解器自己的账上
+    void init(MemTracker* tracker)
+    {
+        mem = tracker;
+        lit_val.grow_to(2, (signed char)UNASSIGNED);
+        level.grow_to(1, 0);
+        reason.grow_to(1, CREF_NONE);
+        polarity.grow_to(1, (signed char)FALSE);
+        seen.grow_to(1, 0);
+    }
+
+    ~SearchState()
+    {
+        for (int i = 0; i < clauses.size(); i++)
+            if (!clauses[i].deleted && !clauses[i].shared)
+                mem_free(mem, clauses[i].lits, (size_t)clauses[i].size * sizeof(Literal), MEM_CLAUSES);
+    }
+
+    // 变量扩展到n个
+    void grow_vars(int n)
+    {
+        if (n <= num_vars) return;
+        lit_val.grow_to(2 * n + 2, (signed char)UNASSIGNED);
+        level.grow_to(n + 1, 0);
+        reason.grow_to(n + 1, CREF_NONE);
+        polarity.grow_to(n + 1, (signed char)FALSE);
+        seen.grow_to(n + 1, 0);
+        num_vars = n;
+    }
+
+    int value(Literal lit) const { return lit_val[lit_index(lit)]; }
+    int decision_level() const { return trail_lim.size(); }
+
+    // 赋值并入队
+    void assign(Literal lit, int from)
+    {
+        Variable v = lit_var(lit);
+        lit_val[lit_index(lit)] = TRUE;
+        lit_val[lit_index(-lit)] = FALSE;
+        level[v] = decision_level();
+        reason[v] = from;
+        trail.push(lit);
+    }
+
+    void unassign(Literal lit)
+    {
+        Variable v = lit_var(lit);
+        lit_val[lit_index(lit)] = UNASSIGNED;
+        lit_val[lit_index(-lit)] = UNASSIGNED;
+        polarity[v] = lit > 0 ? TRUE : FALSE;
+        reason[v] = CREF_NONE;
+    }
+
+    // 新建子句, lits被复制
+    int alloc_clause(const Literal* lits, int size, int learnt)
+    {
+        int cref = new_slot();
+        CoreClause& c = clauses[cref];
+        c.lits = (Literal*)mem_alloc(mem, (size_t)size * sizeof(Literal), MEM_CLAUSES);
+        if (!c.lits) {
+            c.deleted = 1;
+            free_crefs.push(cref);
+            mem_fail("alloc_clause");
+        }
+        memcpy(c.lits, lits, (size_t)size * sizeof(Literal));
+        c.shared = 0;
+        init_slot(c, size, learnt);
+        return cref;
+    }
+
+    // 新建原始子句, 直接引用外面的只读文字数组
+    int alloc_shared_clause(const Literal* lits, int size)
+    {
+        int cref = new_slot();
+        CoreClause& c = clauses[cref];
+        c.lits = (Literal*)lits;    // 只读, 求解器不会改文字顺序
+        c.shared = 1;
+        init_slot(c, size, FALSE);
+        return cref;
+    }
+
+    int new_slot()
+    {
+        if (free_crefs.size() > 0) {
+            int cref = free_crefs.last();
+            free_crefs.pop();
+            return cref;
+        }
+        CoreClause blank;
+        memset(&blank, 0, sizeof(blank));
+        clauses.push(blank);
+        return clauses.size() - 1;
+    }
+
+    void init_slot(CoreClause& c, int size, int learnt)
+    {
+        c.size = size;
+        c.watch[0] = c.lits[0];
+        c.watch[1] = size > 1 ? c.lits[1] : 0;
+        c.lbd = 0;
+        c.activity = 0.0f;
+        c.learnt = (unsigned char)(learnt ? 1 : 0);
+        c.deleted = 0;
+        c.vivified = 0;
+        if (learnt) num_learnts++;
+        else num_originals++;
+    }
+
+    // 删除子句(调用者负责先从传播结构里摘掉)
+    void free_clause(int cref)
+    {
+        CoreClause& c = clauses[cref];
+        if (c.learnt) num_learnts--;
+        else num_originals--;
+        if (!c.shared) mem_free(mem, c.lits, (size_t)c.size * sizeof(Literal), MEM_CLAUSES);
+        c.lits = NULL;
+        c.shared = 0;
+        c.size = 0;
+        c.deleted = 1;
+        free_crefs.push(cref);
+    }
+
+    // 子句是否是某个当前赋值的原因, 是的话不能删
+    int is_locked(int cref) const
+    {
+        const CoreClause& c = clauses[cref];
+        for (int i = 0; i < c.size; i++) {
+            Literal l = c.lits[i];
+            if (value(l) == TRUE && reason[lit_var(l)] == cref) return TRUE;
+        }
+        return FALSE;
+    }
+
+    // xorshift, 只用来打散初始顺序
+    unsigned int next_random()
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+};
+
+#endif // SEARCH_STATE_H
@@ -0,0 +1,90 @@
+#ifndef SIMPLIFIER_H
+#define SIMPLIFIER_H
+
+#include "preprocess.h"
+#include "search_state.h"
+
+// =========== 化简用的子句数据库 ===========
+// 预处理的各个技术都在这上面做: 子句文字首尾相接存在一起, 出现表随时保持准确
+// (删子句, 删文字时同步从出现表里摘掉), 第0层的单元马上传播掉
+
+typedef struct {
+    int start;                  // 文字在 Simplifier::lits 里的起点
+    int size;
+    unsigned long long sig;     // 包含检查用的签名, 缩短时重算
+    unsigned char deleted;
+} SimpClause;
+
+struct Simplifier {
+    int num_vars;
+    int ok;                                 // FALSE: 已经推出空子句
+    Vec<Literal, MEM_CLAUSES> lits;         // 删掉或缩短的子句留下的空洞不回收
+    Vec<SimpClause, MEM_CLAUSES> clauses;   // 下标就是cref
+    int num_clauses;                        // 没删除的子句数
+    Vec<Vec<int>, MEM_WATCHES> occurs;      // 按lit_index: 含有该文字的子句
+    Vec<signed char, MEM_TRAIL> val;        // 按变量: TRUE/FALSE/UNASSIGNED
+    Vec<char, MEM_TRAIL> eliminated;        // 按变量: 已经从公式里去掉
+    Vec<Literal, MEM_TRAIL> units;          // 赋值顺序, units_head 之后的还没传播
+    int units_head;
+    Vec<char, MEM_OTHER> mark;              // 按lit_index, 临时用, 用完清零
+    Vec<Literal, MEM_CLAUSES>* recon;       // 重建栈
+    PreprocessStats* stats;
+};
+
+inline int simp_value(const Simplifier* s, Literal lit)
+{
+    int v = s->val[lit_var(lit)];
+    if (v == UNASSIGNED) return UNASSIGNED;
+    return lit > 0 ? v : !v;
+}
+
+inline Literal* simp_lits(Simplifier* s, int cref) { return s->lits.data() + s->clauses[cref].start; }
+
+// 从CNF建库, 去掉重复文字和重言式, 传播单元. 内存不够抛 MemoryExhausted
+void simp_init(Simplifier* s, const CNF* cnf, Vec<Literal, MEM_CLAUSES>* recon, PreprocessStats* stats);
+// 加一个子句: 去掉假文字, 满足的和重言式不加, 单元直接赋值. 返回cref, 没加返回-1
+int simp_add_clause(Simplifier* s, const Literal* lits, int size);
+// 删除子句并从出现表摘掉
+void simp_remove_clause(Simplifier* s, int cref);
+// 从子句里去掉一个文字, 剩一个文字时变成单元
+void simp_strengthen(Simplifier* s, int cref, Literal lit);
+// 第0层赋值并入队
+void simp_assign(Simplifier* s, Literal lit);
+// 传播所有待传播的单元, 矛盾时 ok 置 FALSE 并返回 FALSE
+int simp_propagate(Simplifier* s);
+// 子句压进重建栈, witness 放在第一个
+void simp_push_recon(Simplifier* s, int cref, Literal witness);
+// 同上, 子句不在库里(witness 必须是 lits 里的一个)
+void simp_push_recon_lits(Simplifier* s, const Literal* lits, int size, Literal witness);
+// 结果写成CNF, 定下来的变量写成单元子句
+int simp_output(Simplifier* s, CNF* out, int num_variables);
+
+// 门定义: 输出文字是输入的 AND / XOR / ITE, clauses 是定义它的那些子句
+enum GateType { GATE_AND = 1, GATE_XOR, GATE_ITE };
+
+struct Gate {
+    int type;
+    Literal output;             // XOR: output = a ^ b; ITE: output = c ? t : e
+    Vec<Literal> inputs;        // AND: 排好序的文字; XOR: 两个变量; ITE: c, t, e(c 和 t 是正的)
+    Vec<int> clauses;
+};
+
+// 找输出变量是v的门(两个极性都试), 找到返回TRUE. budget 按看过的文字数扣, 见 gates.cpp
+int simp_find_gate(Simplifier* s, Variable v, Gate* g, long long* budget);
+// 结构哈希: 合并函数相同的门, 合并后做等价替换
+void simp_hash_gates(Simplifier* s, const PreprocessOptions* options);
+
+// 变量消元, 见 elim.cpp
+void simp_eliminate(Simplifier* s, const PreprocessOptions* options);
+// 包含和自包含resolution, 见 subsume.cpp
+void simp_subsume(Simplifier* s, const PreprocessOptions* options);
+// 失败文字探测, 见 probe.cpp
+void simp_probe(Simplifier* s, const PreprocessOptions* options);
+// 等价文字替换, 见 substitute.cpp
+void simp_substitute(Simplifier* s);
+// 阻塞子句消除(可选覆盖子句消除), 见 blocked.cpp
+void simp_eliminate_blocked(Simplifier* s, const PreprocessOptions* options);
+// 有界变量添加, 会加新变量(num_vars 变大), 见 bva.cpp
+void simp_add_variables(Simplifier* s, const PreprocessOptions* options);
+
+#endif // SIMPLIFIER_H
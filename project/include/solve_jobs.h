@@ -0,0 +1,39 @@
+#ifndef SOLVE_JOBS_H
+#define SOLVE_JOBS_H
+
+#include "sat_data_structures.h"
+#include "solver_engine.h"
+
+// =========== 异步求解作业 ===========
+// 提交一个CNF, 马上拿回作业句柄(相当于future), 之后可以轮询, 等待, 取消
+// 所有作业在一个进程内共享的固定大小线程池里跑, 提交本身不会阻塞
+// 进度回调用 SolverConfig.progress, 在工作线程里调用, 间隔由 progress_interval 控制
+
+typedef struct SolveJob SolveJob;
+
+// 设置线程池大小, 只能在第一次提交之前调用; 0 表示按CPU核数
+// 已经启动过返回FALSE
+int sat_jobs_init(int workers);
+
+// 提交作业, cnf 会被复制, 调用之后可以立刻释放; config 为NULL时用默认配置
+// 失败(内存不够)返回NULL
+SolveJob* sat_job_submit(const CNF* cnf, const SolverConfig* config);
+
+// 不阻塞: 已经有结果返回TRUE, result 可以为NULL
+int sat_job_poll(SolveJob* job, SatResult* result);
+// 阻塞到有结果
+SatResult sat_job_wait(SolveJob* job);
+// 最多等 seconds 秒, 有结果返回TRUE
+int sat_job_wait_for(SolveJob* job, double seconds);
+
+// 取消: 还在排队的直接结束, 正在跑的在下一个检查点停下; 结果都是UNKNOWN(cancelled)
+void sat_job_cancel(SolveJob* job);
+
+// 以下只能在有结果之后调用
+int sat_job_model_value(const SolveJob* job, Variable var);
+const SolverStats* sat_job_stats(const SolveJob* job);
+
+// 不再需要这个作业; 还没结束的会先被取消, 资源由工作线程回收
+void sat_job_release(SolveJob* job);
+
+#endif // SOLVE_JOBS_H
@@ -0,0 +1,218 @@
+#ifndef SOLVER_ENGINE_H
+#define SOLVER_ENGINE_H
+
+#include "sat_data_structures.h"
+#include "mem_track.h"
+#include <atomic>
+
+class ClauseExchange;
+
+// =========== 求解器配置 ===========
+// 启动时从命令行选一次, 之后由 create_solver_engine 选出对应的模板实例,
+// 搜索循环里不再有任何运行时分支或函数指针
+
+// 决策启发式
+typedef enum {
+    HEURISTIC_VSIDS,    // 冲突驱动的变量活跃度 + 相位保存
+    HEURISTIC_JW,       // Jeroslow-Wang 文字权重(原来dpll用的那个)
+    HEURISTIC_COUNT
+} HeuristicKind;
+
+// 传播方式
+typedef enum {
+    PROPAGATION_WATCHED,    // 双文字监视
+    PROPAGATION_COUNTING,   // 出现表 + 计数器(variable_index_optimization.md 的方案)
+    PROPAGATION_COUNT
+} PropagationKind;
+
+// 重启策略
+typedef enum {
+    RESTART_LUBY,
+    RESTART_GEOMETRIC,
+    RESTART_NONE,
+    RESTART_COUNT
+} RestartKind;
+
+// 变量第一次被决策时的相位, 之后都用相位保存
+typedef enum {
+    PHASE_FALSE,
+    PHASE_TRUE,
+    PHASE_RANDOM,       // 按 seed 随机
+    PHASE_COUNT
+} PhaseKind;
+
+// solve 返回 UNKNOWN 的原因
+typedef enum {
+    STOP_NONE,          // 没有中断, 得到了SAT/UNSAT
+    STOP_TIME,
+    STOP_CONFLICTS,
+    STOP_DECISIONS,
+    STOP_PROPAGATIONS,
+    STOP_MEMORY,
+    STOP_CANCELLED,     // interrupt() 或者 SIGINT/SIGTERM
+    STOP_WORKER_LOST,   // 分布式模式下工作进程都退出了
+    STOP_REASON_COUNT
+} StopReason;
+
+// 搜索中的化简技术(见 search_engine.h 的 inprocess), 按这个顺序在同一轮里做
+typedef enum {
+    INPROCESS_PROBE,        // 失败文字探测
+    INPROCESS_SUBSTITUTE,   // 等价文字替换
+    INPROCESS_SUBSUME,      // 学习子句的包含和自包含resolution
+    INPROCESS_VIVIFY,       // 学习子句活化
+    INPROCESS_ELIM,         // 有界变量消去
+    INPROCESS_COUNT
+} InprocessTechnique;
+
+#define INPROCESS_ALL ((1 << INPROCESS_COUNT) - 1)
+
+// =========== 求解统计 ===========
+// 一种化简技术累计的开销和效果
+typedef struct {
+    long long calls;            // 做了几轮
+    double seconds;             // 墙钟时间
+    long long clauses;          // 删掉的子句
+    long long literals;         // 从留下的子句里去掉的文字
+    long long variables;        // 定下来, 替换掉或者消掉的变量
+} InprocessStats;
+
+typedef struct {
+    long long decisions;        // 决策次数
+    long long propagations;     // 单元传播次数(出队的文字数)
+    long long conflicts;        // 冲突次数
+    long long restarts;         // 重启次数
+    long long learned_clauses;  // 学到的子句总数
+    long long learned_literals; // 学到的文字总数(最小化之后)
+    long long minimized_literals;   // 冲突分析里递归最小化去掉的文字
+    long long vivified_clauses; // 做过活化的学习子句, 去掉的文字见 inprocess[INPROCESS_VIVIFY]
+    long long deleted_clauses;  // 被reduce_db删掉的学习子句
+    InprocessStats inprocess[INPROCESS_COUNT];  // 搜索中的化简, 按 InprocessTechnique
+    int max_level;              // 最深的决策层
+    // 子句交换(见 clause_exchange.h), 不在portfolio里时都是0
+    long long shared_exported;  // 导出的
+    long long shared_imported;  // 从别的线程读进来的
+    long long shared_dropped;   // 超过导出速率上限, 或者槽位冲突没导出的
+    long long shared_missed;    // 没来得及读就被覆盖的
+    StopReason stop_reason;     // 最近一次solve为什么停下
+    MemTracker memory;          // 求解器自己的内存记账(solve结束时的快照)
+} SolverStats;
+
+// 进度回调: 在求解线程里调用, 参数是当时的统计
+typedef void (*SolveProgressFn)(const SolverStats* stats, void* user);
+
+// 求解器配置
+typedef struct {
+    HeuristicKind heuristic;
+    PropagationKind propagation;
+    RestartKind restart;
+    PhaseKind phase;
+    unsigned int seed;      // 0 表示不加随机扰动
+    long long mem_limit;    // 求解器内存上限(字节), 0 表示不限
+
+    // 每次 solve 的预算, 0 表示不限; 用完了 solve 返回 UNKNOWN
+    double time_limit;              // 墙钟时间(秒)
+    long long conflict_limit;
+    long long decision_limit;
+    long long propagation_limit;
+
+    // 进度回调, NULL 表示不需要; 两次回调之间至少隔 progress_interval 秒
+    SolveProgressFn progress;
+    void* progress_user;
+    double progress_interval;
+
+    // 子句交换: 长度不超过 share_max_size 且 LBD 不超过 share_lbd 的学习子句导出给别的线程
+    // share_rate 是导出速率上限: 平均每个冲突最多导出这么多个文字(单元子句不算)
+    int share_lbd;          // 0 表示不交换
+    int share_max_size;     // 不超过 EXCHANGE_MAX_SIZE
+    int share_rate;
+
+    // 搜索中的化简: 每隔 inprocess_interval 个冲突, 在重启时按 inprocess_mask(1 << InprocessTechnique)
+    // 做一轮. 每种技术的工作量是上一轮以来传播次数的 inprocess_effort 千分之一
+    long long inprocess_interval;   // 0 表示不做
+    int inprocess_mask;
+    int inprocess_effort;
+} SolverConfig;
+
+// 几个求解器一起花的一份预算(cube-and-conquer 的各个线程)
+// 截止时刻是绝对时间, 计数是所有接上的求解器加起来的; 用完了各自的 solve 返回 UNKNOWN
+typedef struct {
+    double deadline;                // solver_wall_seconds() 的时刻, 0 表示不限
+    long long conflict_limit;       // 0 表示不限
+    long long decision_limit;
+    long long propagation_limit;
+    std::atomic<long long> conflicts;
+    std::atomic<long long> decisions;
+    std::atomic<long long> propagations;
+} SolverBudget;
+
+// =========== 求解器接口 ===========
+// 具体实现是 SearchEngine<启发式, 传播, 重启, 统计> 的某个实例
+class SolverEngine {
+public:
+    virtual ~SolverEngine() {}
+
+    // 添加子句, 返回FALSE表示公式已经在第0层矛盾
+    // 两次solve之间可以继续加, 学习子句/活跃度/相位都保留
+    virtual int add_clause(const Literal* lits, int size) = 0;
+    // 在假设文字都为真的前提下搜索, 假设只对这一次有效
+    // UNSAT 时 failed_assumptions 给出导致矛盾的那部分假设
+    virtual SatResult solve(const Literal* assumptions, int count) = 0;
+    SatResult solve() { return solve(NULL, 0); }
+    // 不带假设地搜索, 再做 propagations 次传播还没结果就暂停: 返回UNKNOWN(STOP_PROPAGATIONS),
+    // 赋值和搜索状态都留着, 下一次 resume 从原地接着走. 把一次求解切成几段用(确定性portfolio)
+    // 暂停时调用 solve 或 add_clause 会先回到第0层
+    virtual SatResult resume(long long propagations) = 0;
+    // 和 add_clause 一样, 但是不复制文字: lits 在求解器的整个生命周期里必须有效且不变
+    // portfolio 里多个线程用它共享同一份原始子句(见 clause_store.h)
+    virtual int add_shared_clause(const Literal* lits, int size) = 0;
+    // 最近一次 UNSAT 用到的假设(原样的文字), 公式本身就矛盾时为空
+    virtual const Literal* failed_assumptions(int* count) const = 0;
+    // SAT之后读模型: TRUE/FALSE
+    virtual int model_value(Variable var) const = 0;
+    virtual int num_variables() const = 0;
+    virtual const SolverStats& stats() const = 0;
+    // 让正在进行的 solve 在下一个检查点返回UNKNOWN, 可以从别的线程调用
+    virtual void interrupt() = 0;
+    // 接到子句交换上, id 是这个求解器在交换里的编号; 之后每次重启时导入别人的子句
+    // exchange 必须比求解器活得长
+    virtual void connect_exchange(ClauseExchange* exchange, int id) = 0;
+    // 接到共用预算上, 之后的 solve 不再按 config 里的每次预算算; NULL 表示断开
+    // budget 必须比求解器活得长
+    virtual void share_budget(SolverBudget* budget) = 0;
+};
+
+// 配置相关
+void init_solver_config(SolverConfig* config);
+// 按 config 的预算从现在开始算, 计数清零
+void init_solver_budget(SolverBudget* budget, const SolverConfig* config);
+// 解析 --heuristic/--propagation/--restart 的取值, 失败返回0
+int parse_heuristic(const char* name, HeuristicKind* out);
+int parse_propagation(const char* name, PropagationKind* out);
+int parse_restart(const char* name, RestartKind* out);
+int parse_phase(const char* name, PhaseKind* out);
+// 形如 "vsids/watched/luby", 相位和种子不是默认值时追加在后面
+void describe_solver_config(const SolverConfig* config, char* buf, int size);
+
+// =========== 取消 ===========
+// 进程级的取消标志, 所有求解器在检查点上读它
+// request_cancel 只写一个 sig_atomic_t, 可以在信号处理函数里调用
+void request_cancel(void);
+int cancel_requested(void);
+void reset_cancel(void);
+// SIGINT/SIGTERM 改成 request_cancel; 第二次收到信号时按默认方式结束进程
+void install_cancel_handlers(void);
+
+// 单调时钟(秒), 用来算时间预算
+double solver_wall_seconds(void);
+// "time limit" 之类, 用于输出
+const char* stop_reason_name(StopReason reason);
+
+// 按配置选出编译好的模板实例, 调用者负责delete
+SolverEngine* create_solver_engine(const SolverConfig* config);
+
+// 状态/统计输出
+void print_solver_stats(const SolverStats* stats);
+// 可以直接当 SolveProgressFn 用: 输出一行 "Solving... Decisions: ..."
+void print_solver_progress(const SolverStats* stats, void* user);
+
+#endif // SOLVER_ENGINE_H
@@ -0,0 +1,55 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Chrome/Perfetto trace-event 导出 (chrome://tracing 或 ui.perfetto.dev 直接打开)
+// 只有用 -DSAT_ENABLE_TRACE=ON 编译时才定义 SAT_TRACE, 否则下面的宏全部展开为空,
+// 热循环里不会多出任何代码
+
+// 打开/关闭trace文件, 没有编译trace时trace_open返回0
+int trace_open(const char* filename);
+void trace_close(void);
+// 当前是否在写trace(编译了但没打开文件时也是0)
+int trace_active(void);
+
+// 底层接口, 一般通过下面的宏使用
+long long trace_now_us(void);
+void trace_complete(const char* name, long long start_us, long long end_us);
+void trace_counter(const char* name, double value);
+void trace_instant(const char* name);
+// 给当前线程的轨道起名, 显示成 "name index"
+void trace_thread_name(const char* name, int index);
+
+#ifdef SAT_TRACE
+
+// 作用域span: 构造时记时间, 析构时写一个完整事件
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name_(name), start_us_(trace_active() ? trace_now_us() : -1) {}
+    ~TraceScope() { if (start_us_ >= 0) trace_complete(name_, start_us_, trace_now_us()); }
+private:
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+    const char* name_;
+    long long start_us_;
+};
+
+#define SAT_TRACE_CONCAT_(a, b) a##b
+#define SAT_TRACE_CONCAT(a, b) SAT_TRACE_CONCAT_(a, b)
+
+#define TRACE_ENABLED 1
+#define TRACE_SCOPE(name) TraceScope SAT_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_COUNTER(name, value) do { if (trace_active()) trace_counter(name, (double)(value)); } while (0)
+#define TRACE_INSTANT(name) do { if (trace_active()) trace_instant(name); } while (0)
+#define TRACE_THREAD_NAME(name, index) do { if (trace_active()) trace_thread_name(name, index); } while (0)
+
+#else
+
+#define TRACE_ENABLED 0
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_INSTANT(name) do {} while (0)
+#define TRACE_THREAD_NAME(name, index) do {} while (0)
+
+#endif // SAT_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,122 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include "mem_track.h"
+
+// =========== 简易动态数组 ===========
+// sat_data_structures.h 结尾那句"不如写个vector.h"终于兑现了
+// 和 LiteralArray 一样用 malloc/realloc 管理内存, 元素必须可以按字节搬移
+// (整数, 指针, 普通结构体, 或者 Vec 本身)
+// 内存记在第一次分配时的当前 MemTracker 的 Sub 子系统上, 之后一直记在同一个上面
+template <class T, MemSubsystem Sub = MEM_OTHER>
+class Vec {
+public:
+    Vec() : data_(NULL), size_(0), capacity_(0), tracker_(NULL) {}
+    ~Vec() { release(); }
+
+    int size() const { return size_; }
+    int capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](int i) { return data_[i]; }
+    const T& operator[](int i) const { return data_[i]; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T& last() { return data_[size_ - 1]; }
+    const T& last() const { return data_[size_ - 1]; }
+
+    // cos一下.push_back()
+    void push(const T& x)
+    {
+        if (size_ >= capacity_) grow(size_ + 1);
+        new (&data_[size_]) T(x);
+        size_++;
+    }
+
+    void pop()
+    {
+        size_--;
+        data_[size_].~T();
+    }
+
+    // 截断到n个元素
+    void shrink(int n)
+    {
+        while (size_ > n) pop();
+    }
+
+    void clear() { shrink(0); }
+
+    // 扩展到n个元素, 新元素用pad填充
+    void grow_to(int n, const T& pad)
+    {
+        if (n <= size_) return;
+        if (n > capacity_) grow(n);
+        for (int i = size_; i < n; i++) new (&data_[i]) T(pad);
+        size_ = n;
+    }
+
+    // 扩展到n个元素, 新元素默认构造
+    void grow_to(int n)
+    {
+        if (n <= size_) return;
+        if (n > capacity_) grow(n);
+        for (int i = size_; i < n; i++) new (&data_[i]) T();
+        size_ = n;
+    }
+
+    void reserve(int n)
+    {
+        if (n > capacity_) grow(n);
+    }
+
+    // 释放空间
+    void release()
+    {
+        clear();
+        if (data_) mem_free(tracker_, data_, (size_t)capacity_ * sizeof(T), Sub);
+        data_ = NULL;
+        capacity_ = 0;
+    }
+
+    void swap(Vec& other)
+    {
+        T* d = data_; data_ = other.data_; other.data_ = d;
+        int s = size_; size_ = other.size_; other.size_ = s;
+        int c = capacity_; capacity_ = other.capacity_; other.capacity_ = c;
+        MemTracker* t = tracker_; tracker_ = other.tracker_; other.tracker_ = t;
+    }
+
+    void copy_to(Vec& dest) const
+    {
+        dest.clear();
+        dest.reserve(size_);
+        for (int i = 0; i < size_; i++) dest.push(data_[i]);
+    }
+
+private:
+    Vec(const Vec&);
+    Vec& operator=(const Vec&);
+
+    // 每次翻两倍, 分配失败抛 MemoryExhausted
+    void grow(int min_capacity)
+    {
+        int cap = capacity_ > 0 ? capacity_ : 4;
+        while (cap < min_capacity) cap *= 2;
+        if (!tracker_) tracker_ = mem_current_tracker();
+        T* p = (T*)mem_realloc(tracker_, (void*)data_, (size_t)capacity_ * sizeof(T), (size_t)cap * sizeof(T), Sub);
+        if (!p) mem_fail("Vec::grow");
+        data_ = p;
+        capacity_ = cap;
+    }
+
+    T* data_;
+    int size_;
+    int capacity_;
+    MemTracker* tracker_;
+};
+
+#endif // VEC_H
@@ -0,0 +1,78 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "sat_data_structures.h"
+#include "vec.h"
+
+// =========== 协调者和工作进程之间的二进制协议 ===========
+// 每条消息 = 8字节的头(类型, 载荷字节数; 都是小端的uint32) + 载荷
+// 载荷是一串小端的32位整数, 64位的数拆成两个(低位在前)
+// 协议只要求通道能按顺序读写字节(见 WireChannel): 现在用本机的 Unix socket,
+// 以后换成TCP或者ssh的标准输入输出, 协议本身不用改
+//
+//   HELLO    工作 -> 协调   version
+//   FORMULA  协调 -> 工作   num_vars, num_clauses, 然后每个子句: size, lits...
+//   WORK     协调 -> 工作   id, heuristic, propagation, restart, phase, seed, mem_limit(64),
+//                           time_limit_ms(64), conflict_limit(64), decision_limit(64), propagation_limit(64),
+//                           share_lbd, share_max_size, share_rate, inprocess_interval(64), inprocess_mask,
+//                           inprocess_effort, n, n个假设文字
+//                           预算是整个求解还剩下的, 不是每个WORK各一份
+//   RESULT   工作 -> 协调   id, result, stop_reason, decisions(64), propagations(64), conflicts(64),
+//                           SAT时再跟 num_vars 和按位打包的模型(每32个变量一个字, 变量v在第v位)
+//   CLAUSE   双向           size, lits...   (学到的单元和二元子句)
+//   STOP     协调 -> 工作   打断正在跑的WORK, 工作进程照样回一个RESULT
+//   QUIT     协调 -> 工作   退出
+
+#define WIRE_VERSION 2
+#define WIRE_MAX_PAYLOAD (256 << 20)    // 单条消息载荷上限(字节), 超过的当成坏消息
+
+typedef enum {
+    WIRE_HELLO = 1,
+    WIRE_FORMULA,
+    WIRE_WORK,
+    WIRE_RESULT,
+    WIRE_CLAUSE,
+    WIRE_STOP,
+    WIRE_QUIT
+} WireType;
+
+// 通道: 读写恰好n个字节, 成功返回TRUE, 结束或者出错返回FALSE
+typedef struct {
+    int (*read)(void* ctx, void* buf, size_t n);
+    int (*write)(void* ctx, const void* buf, size_t n);
+    void* ctx;
+    long long bytes_in;         // 统计用
+    long long bytes_out;
+} WireChannel;
+
+// 文件描述符上的通道(管道, socket); fds 由调用者保管, 生命周期要覆盖 channel
+typedef struct {
+    int in_fd;
+    int out_fd;
+} WireFds;
+
+void wire_fd_channel(WireChannel* channel, WireFds* fds);
+
+// 一条消息, 载荷已经换成本机字节序
+struct WireMessage {
+    int type;
+    Vec<int> words;
+    int pos;                    // 解码读到哪了
+
+    WireMessage() : type(0), pos(0) {}
+};
+
+// 编码
+void wire_begin(WireMessage* msg, int type);
+void wire_put(WireMessage* msg, int x);
+void wire_put64(WireMessage* msg, long long x);
+// 解码, 数据不够返回FALSE
+int wire_get(WireMessage* msg, int* x);
+int wire_get64(WireMessage* msg, long long* x);
+
+// 发送/接收一整条消息, 失败(对方关闭, 出错, 消息格式不对)返回FALSE
+// 分配失败抛 MemoryExhausted
+int wire_send(WireChannel* channel, const WireMessage* msg);
+int wire_recv(WireChannel* channel, WireMessage* msg);
+
+#endif // WIRE_H
@@ -0,0 +1,187 @@
+#include "simplifier.h"
+
+// =========== 阻塞子句消除 ===========
+// 子句C在文字l上阻塞: 所有含-l的子句D和C在l上的resolvent都是重言式.
+// 这样的C删掉不影响可满足性, 重建栈记下C, 见证文字是l: 补模型时C不满足就把l设成真.
+// 按文字处理, 含-l的子句少的先看. 删掉一个子句以后, 对它里面的每个文字m,
+// 含m的子句少了一个要检查的D, 所以 -m 重新排进队列
+//
+// 覆盖子句消除(可选): 对C里的文字l, 和C的resolvent不是重言式的那些D,
+// 除了-l以外的公共文字(覆盖文字)可以加进C; 加完以后阻塞就删掉C.
+// 重建栈按扩展的顺序压每一步扩展前的子句(见证是那一步的l), 最后压阻塞的扩展子句.
+// 倒着补模型时先满足扩展后的子句, 再一步步退回到C: 某一步的子句不满足时,
+// 后一步加进来的覆盖文字里有真的, 而每个非重言的D都含有这些文字, 把l设成真不会破坏D
+
+#define COVER_MAX_SIZE 64       // 覆盖扩展的子句最多这么长
+
+typedef struct {
+    Literal lit;
+    int key;
+} BlockedCandidate;
+
+static int compare_blocked_candidates(const void* a, const void* b)
+{
+    const BlockedCandidate* x = (const BlockedCandidate*)a;
+    const BlockedCandidate* y = (const BlockedCandidate*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->lit < y->lit ? -1 : (x->lit > y->lit ? 1 : 0);
+}
+
+struct BlockedScratch {
+    Vec<Literal> queue;
+    Vec<char> queued;               // 按lit_index
+    Vec<int> cands;
+    Vec<char> mark2;                // 按lit_index, 求交集用
+    Vec<Literal> ext;               // 覆盖扩展中的子句
+    Vec<Literal> inter;             // 这一步的覆盖文字
+    Vec<int> step_size;             // 每一步扩展前的子句长度
+    Vec<Literal> step_pivot;        // 每一步的l
+    long long budget;
+};
+
+// 调用前C(或者它的扩展)的文字已经标在 s->mark 上
+// 含-l的子句和它的resolvent是否都是重言式
+static int resolvents_tautological(Simplifier* s, Literal l, BlockedScratch* w)
+{
+    const Vec<int>& occ = s->occurs[lit_index(-l)];
+    for (int i = 0; i < occ.size(); i++) {
+        const Literal* p = simp_lits(s, occ[i]);
+        int n = s->clauses[occ[i]].size;
+        w->budget -= n;
+        int tautology = FALSE;
+        for (int k = 0; k < n && !tautology; k++)
+            tautology = p[k] != -l && s->mark[lit_index(-p[k])];
+        if (!tautology) return FALSE;
+    }
+    return TRUE;
+}
+
+static void enqueue(BlockedScratch* w, Literal l)
+{
+    if (w->queued[lit_index(l)]) return;
+    w->queued[lit_index(l)] = 1;
+    w->queue.push(l);
+}
+
+static void mark_clause(Simplifier* s, int cref, char value)
+{
+    const Literal* p = simp_lits(s, cref);
+    for (int k = 0; k < s->clauses[cref].size; k++) s->mark[lit_index(p[k])] = value;
+}
+
+static void eliminate_blocked(Simplifier* s, BlockedScratch* w)
+{
+    for (int qi = 0; qi < w->queue.size() && w->budget > 0; qi++) {
+        Literal l = w->queue[qi];
+        w->queued[lit_index(l)] = 0;
+        if (s->val[lit_var(l)] != UNASSIGNED || s->eliminated[lit_var(l)]) continue;
+        s->occurs[lit_index(l)].copy_to(w->cands);
+        for (int i = 0; i < w->cands.size() && w->budget > 0; i++) {
+            int c = w->cands[i];
+            if (s->clauses[c].deleted) continue;
+            mark_clause(s, c, 1);
+            int blocked = resolvents_tautological(s, l, w);
+            mark_clause(s, c, 0);
+            if (!blocked) continue;
+            simp_push_recon(s, c, l);
+            const Literal* p = simp_lits(s, c);
+            for (int k = 0; k < s->clauses[c].size; k++)
+                if (p[k] != l) enqueue(w, -p[k]);
+            simp_remove_clause(s, c);
+            s->stats->blocked++;
+        }
+    }
+}
+
+// 给 ext 加上l的覆盖文字; 没有非重言的resolvent(l上阻塞)时返回TRUE
+static int add_covered(Simplifier* s, Literal l, BlockedScratch* w)
+{
+    const Vec<int>& occ = s->occurs[lit_index(-l)];
+    int first = TRUE;
+    w->inter.clear();
+    for (int i = 0; i < occ.size(); i++) {
+        const Literal* p = simp_lits(s, occ[i]);
+        int n = s->clauses[occ[i]].size;
+        w->budget -= n;
+        int tautology = FALSE;
+        for (int k = 0; k < n && !tautology; k++)
+            tautology = p[k] != -l && s->mark[lit_index(-p[k])];
+        if (tautology) continue;
+        if (first) {
+            for (int k = 0; k < n; k++)
+                if (p[k] != -l && !s->mark[lit_index(p[k])]) w->inter.push(p[k]);
+            first = FALSE;
+        } else {
+            for (int k = 0; k < n; k++) w->mark2[lit_index(p[k])] = 1;
+            int j = 0;
+            for (int k = 0; k < w->inter.size(); k++)
+                if (w->mark2[lit_index(w->inter[k])]) w->inter[j++] = w->inter[k];
+            w->inter.shrink(j);
+            for (int k = 0; k < n; k++) w->mark2[lit_index(p[k])] = 0;
+        }
+        if (w->inter.size() == 0) return FALSE;
+    }
+    if (first) return TRUE;
+    w->step_size.push(w->ext.size());
+    w->step_pivot.push(l);
+    for (int k = 0; k < w->inter.size() && w->ext.size() < COVER_MAX_SIZE; k++) {
+        w->ext.push(w->inter[k]);
+        s->mark[lit_index(w->inter[k])] = 1;
+    }
+    return FALSE;
+}
+
+// 覆盖扩展到阻塞就删掉子句, 返回是否删了
+static int eliminate_covered(Simplifier* s, int c, BlockedScratch* w)
+{
+    const Literal* p = simp_lits(s, c);
+    w->ext.clear();
+    w->step_size.clear();
+    w->step_pivot.clear();
+    for (int k = 0; k < s->clauses[c].size; k++) w->ext.push(p[k]);
+    for (int k = 0; k < w->ext.size(); k++) s->mark[lit_index(w->ext[k])] = 1;
+
+    // 扩展以后前面看过的文字也可能变成阻塞, 所以从头再看
+    Literal blocking = 0;
+    for (int i = 0; i < w->ext.size() && blocking == 0 && w->budget > 0; i++) {
+        int before = w->ext.size();
+        if (add_covered(s, w->ext[i], w)) blocking = w->ext[i];
+        else if (w->ext.size() > before && w->ext.size() < COVER_MAX_SIZE) i = -1;
+    }
+    for (int k = 0; k < w->ext.size(); k++) s->mark[lit_index(w->ext[k])] = 0;
+    if (blocking == 0) return FALSE;
+
+    for (int j = 0; j < w->step_size.size(); j++)
+        simp_push_recon_lits(s, w->ext.data(), w->step_size[j], w->step_pivot[j]);
+    simp_push_recon_lits(s, w->ext.data(), w->ext.size(), blocking);
+    simp_remove_clause(s, c);
+    if (w->step_size.size() > 0) s->stats->covered++;
+    else s->stats->blocked++;
+    return TRUE;
+}
+
+void simp_eliminate_blocked(Simplifier* s, const PreprocessOptions* options)
+{
+    BlockedScratch w;
+    w.budget = options->bce_budget;
+    w.queued.grow_to(2 * s->num_vars + 2, 0);
+    w.mark2.grow_to(2 * s->num_vars + 2, 0);
+
+    Vec<BlockedCandidate> order;
+    for (Variable v = 1; v <= s->num_vars; v++) {
+        if (s->val[v] != UNASSIGNED || s->eliminated[v]) continue;
+        for (int side = 0; side < 2; side++) {
+            Literal l = side ? -v : v;
+            if (s->occurs[lit_index(l)].size() == 0) continue;
+            BlockedCandidate bc = { l, s->occurs[lit_index(-l)].size() };
+            order.push(bc);
+        }
+    }
+    qsort(order.data(), order.size(), sizeof(BlockedCandidate), compare_blocked_candidates);
+    for (int i = 0; i < order.size(); i++) enqueue(&w, order[i].lit);
+    eliminate_blocked(s, &w);
+
+    if (!options->cce) return;
+    for (int c = 0; c < s->clauses.size() && w.budget > 0; c++)
+        if (!s->clauses[c].deleted) eliminate_covered(s, c, &w);
+}
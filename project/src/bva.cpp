@@ -0,0 +1,249 @@
+#include "simplifier.h"
+
+// =========== 有界变量添加(BVA) ===========
+// 一组子句 {l' ∨ R | l' ∈ Mlit, R ∈ Mcls} 一共 |Mlit|*|Mcls| 个, 加一个新变量x以后换成
+// {l' ∨ x} 和 {R ∨ -x}, 只要 |Mlit|+|Mcls| 个; 对x做resolution正好得到原来的子句.
+// 两两编码的 at-most-one (-a ∨ -b 各对) 就是这种形状, 反复做下来接近线性编码.
+// 新公式的模型去掉x就是原公式的模型, 不用进重建栈; 原公式的模型取
+// x = "Mlit 里有假的" 也满足新公式, 所以可满足性不变.
+//
+// 找法(SimpleBVA, Manthey et al. 2012): 从出现多的文字l开始, Mlit={l}, Mcls=含l的子句.
+// 对 Mcls 里每个C, 在C里除l以外出现最少的文字的出现表里找形如 (C - l) ∪ {l'} 的子句D,
+// 记下 (l', C). 出现最多的l'加进 Mlit, Mcls 缩成和l'配上的那些C; 减少的子句数
+// |Mlit|*|Mcls| - |Mlit| - |Mcls| 不再变大时停
+//
+// 预算按剩下的文字数算: 总共最多 BVA_BUDGET_PER_LIT 倍, 上限 bva_budget;
+// 随机公式这种找不到形状的, 连着 BVA_IDLE_PER_LIT 倍没有替换就停, 不把预算花完
+
+#define BVA_BUDGET_PER_LIT 100
+#define BVA_IDLE_PER_LIT 10
+
+typedef struct {
+    Literal lit;
+    int key;
+} BvaCandidate;
+
+// 出现多的在前
+static int compare_bva_candidates(const void* a, const void* b)
+{
+    const BvaCandidate* x = (const BvaCandidate*)a;
+    const BvaCandidate* y = (const BvaCandidate*)b;
+    if (x->key != y->key) return x->key > y->key ? -1 : 1;
+    return x->lit < y->lit ? -1 : (x->lit > y->lit ? 1 : 0);
+}
+
+typedef struct {
+    Literal lit;                // l'
+    int row;                    // C 在 Mcls 里的下标
+    int cref;                   // D = (C - l) ∪ {l'}
+} BvaPair;
+
+struct BvaScratch {
+    Vec<Literal> queue;
+    Vec<char> queued;           // 按lit_index
+    Vec<char> in_mlit;          // 按lit_index
+    Vec<int> count;             // 按lit_index, 每个l'配上的C数
+    Vec<Literal> mlit;
+    Vec<int> mcls;
+    Vec<int> partners;          // 每个C一行, 第j个是和 Mlit[j] 对应的子句(Mlit[0]=l 对应C自己)
+    Vec<int> next_partners;
+    Vec<BvaPair> pairs;
+    Vec<Literal> touched;       // count 非零的文字
+    Vec<Literal> rest;          // 每个C去掉l后的文字, 首尾相接
+    Vec<int> rest_start;
+    Vec<Literal> clause;
+    long long budget;
+};
+
+static long long reduction(int lits, int clauses) { return (long long)lits * clauses - lits - clauses; }
+
+static void enqueue(BvaScratch* w, Literal l)
+{
+    if (w->queued[lit_index(l)]) return;
+    w->queued[lit_index(l)] = 1;
+    w->queue.push(l);
+}
+
+static void mark_clause(Simplifier* s, int cref, char value)
+{
+    const Literal* p = simp_lits(s, cref);
+    for (int k = 0; k < s->clauses[cref].size; k++) s->mark[lit_index(p[k])] = value;
+}
+
+// 调用前C的文字已经标在 s->mark 上. D是 (C - l) ∪ {l'} 时返回l', 否则返回0
+static Literal match_clause(Simplifier* s, int c, int d, Literal l)
+{
+    if (d == c || s->clauses[d].size != s->clauses[c].size) return 0;
+    const Literal* p = simp_lits(s, d);
+    Literal other = 0;
+    for (int k = 0; k < s->clauses[d].size; k++) {
+        if (s->mark[lit_index(p[k])]) {
+            if (p[k] == l) return 0;
+            continue;
+        }
+        if (other != 0) return 0;
+        other = p[k];
+    }
+    return other == -l ? 0 : other;
+}
+
+// Mcls 里每个C配上的 (l', C), l' 不在 Mlit 里
+static void collect_pairs(Simplifier* s, Literal l, BvaScratch* w)
+{
+    w->pairs.clear();
+    for (int i = 0; i < w->mcls.size() && w->budget > 0; i++) {
+        int c = w->mcls[i];
+        const Literal* p = simp_lits(s, c);
+        Literal lmin = 0;
+        for (int k = 0; k < s->clauses[c].size; k++)
+            if (p[k] != l && (lmin == 0 || s->occurs[lit_index(p[k])].size() < s->occurs[lit_index(lmin)].size()))
+                lmin = p[k];
+        mark_clause(s, c, 1);
+        const Vec<int>& occ = s->occurs[lit_index(lmin)];
+        for (int j = 0; j < occ.size(); j++) {
+            w->budget -= s->clauses[occ[j]].size;
+            Literal other = match_clause(s, c, occ[j], l);
+            if (other == 0 || w->in_mlit[lit_index(other)]) continue;
+            BvaPair pr = { other, i, occ[j] };
+            w->pairs.push(pr);
+        }
+        mark_clause(s, c, 0);
+    }
+}
+
+static Variable new_variable(Simplifier* s, BvaScratch* w)
+{
+    Variable x = ++s->num_vars;
+    s->occurs.grow_to(2 * x + 2);
+    s->val.grow_to(x + 1, (signed char)UNASSIGNED);
+    s->eliminated.grow_to(x + 1, 0);
+    s->mark.grow_to(2 * x + 2, 0);
+    w->queued.grow_to(2 * x + 2, 0);
+    w->in_mlit.grow_to(2 * x + 2, 0);
+    w->count.grow_to(2 * x + 2, 0);
+    return x;
+}
+
+// 用新变量替换 Mlit × Mcls
+static void replace_pattern(Simplifier* s, Literal l, BvaScratch* w)
+{
+    w->rest.clear();
+    w->rest_start.clear();
+    for (int i = 0; i < w->mcls.size(); i++) {
+        int c = w->mcls[i];
+        w->rest_start.push(w->rest.size());
+        const Literal* p = simp_lits(s, c);
+        for (int k = 0; k < s->clauses[c].size; k++)
+            if (p[k] != l) w->rest.push(p[k]);
+    }
+    w->rest_start.push(w->rest.size());
+
+    // 重复子句可能让两个位置是同一个D, 删两次没关系
+    int before = s->num_clauses;
+    for (int i = 0; i < w->partners.size(); i++) simp_remove_clause(s, w->partners[i]);
+    Variable x = new_variable(s, w);
+    Literal tmp[2];
+    for (int j = 0; j < w->mlit.size(); j++) {
+        tmp[0] = w->mlit[j];
+        tmp[1] = x;
+        simp_add_clause(s, tmp, 2);
+    }
+    for (int i = 0; i + 1 < w->rest_start.size(); i++) {
+        w->clause.clear();
+        for (int k = w->rest_start[i]; k < w->rest_start[i + 1]; k++) w->clause.push(w->rest[k]);
+        w->clause.push(-x);
+        simp_add_clause(s, w->clause.data(), w->clause.size());
+    }
+    s->stats->bva_variables++;
+    s->stats->bva_clauses += before - s->num_clauses;
+
+    // 新的 -x 子句和 Mlit 里的文字还能再组成别的形状
+    for (int j = 0; j < w->mlit.size(); j++) enqueue(w, w->mlit[j]);
+    enqueue(w, x);
+    enqueue(w, -x);
+}
+
+static void add_variables(Simplifier* s, Literal l, BvaScratch* w)
+{
+    w->mlit.clear();
+    w->mlit.push(l);
+    w->in_mlit[lit_index(l)] = 1;
+    s->occurs[lit_index(l)].copy_to(w->mcls);
+    w->mcls.copy_to(w->partners);
+
+    while (w->budget > 0) {
+        collect_pairs(s, l, w);
+        Literal best = 0;
+        w->touched.clear();
+        for (int i = 0; i < w->pairs.size(); i++) {
+            Literal o = w->pairs[i].lit;
+            if (w->count[lit_index(o)]++ == 0) w->touched.push(o);
+            if (best == 0 || w->count[lit_index(o)] > w->count[lit_index(best)]) best = o;
+        }
+        int best_count = best != 0 ? w->count[lit_index(best)] : 0;
+        for (int i = 0; i < w->touched.size(); i++) w->count[lit_index(w->touched[i])] = 0;
+        if (best == 0 ||
+            reduction(w->mlit.size() + 1, best_count) <= reduction(w->mlit.size(), w->mcls.size()))
+            break;
+
+        w->mlit.push(best);
+        w->in_mlit[lit_index(best)] = 1;
+        // 配上best的C留下, 每行接上对应的D; 一个C可能配上同一个l'好几次(重复子句), 只留一次
+        int width = w->mlit.size() - 1;
+        int kept = 0;
+        int last_row = -1;
+        w->next_partners.clear();
+        for (int i = 0; i < w->pairs.size(); i++) {
+            const BvaPair& pr = w->pairs[i];
+            if (pr.lit != best || pr.row == last_row) continue;
+            last_row = pr.row;
+            w->mcls[kept++] = w->mcls[pr.row];
+            for (int j = 0; j < width; j++) w->next_partners.push(w->partners[pr.row * width + j]);
+            w->next_partners.push(pr.cref);
+        }
+        w->mcls.shrink(kept);
+        w->partners.swap(w->next_partners);
+    }
+
+    for (int j = 0; j < w->mlit.size(); j++) w->in_mlit[lit_index(w->mlit[j])] = 0;
+    // 只省一个子句的不换: 多一个变量换不来什么
+    if (w->mlit.size() > 1 && reduction(w->mlit.size(), w->mcls.size()) > 1) replace_pattern(s, l, w);
+}
+
+void simp_add_variables(Simplifier* s, const PreprocessOptions* options)
+{
+    long long lits = 0;
+    for (int c = 0; c < s->clauses.size(); c++)
+        if (!s->clauses[c].deleted) lits += s->clauses[c].size;
+    BvaScratch w;
+    w.budget = lits * BVA_BUDGET_PER_LIT;
+    if (w.budget > options->bva_budget) w.budget = options->bva_budget;
+    long long last_hit = w.budget;     // 上一次替换之后剩的预算
+    w.queued.grow_to(2 * s->num_vars + 2, 0);
+    w.in_mlit.grow_to(2 * s->num_vars + 2, 0);
+    w.count.grow_to(2 * s->num_vars + 2, 0);
+
+    Vec<BvaCandidate> order;
+    for (Variable v = 1; v <= s->num_vars; v++) {
+        if (s->val[v] != UNASSIGNED || s->eliminated[v]) continue;
+        for (int side = 0; side < 2; side++) {
+            Literal l = side ? -v : v;
+            if (s->occurs[lit_index(l)].size() < 3) continue;
+            BvaCandidate bc = { l, s->occurs[lit_index(l)].size() };
+            order.push(bc);
+        }
+    }
+    qsort(order.data(), order.size(), sizeof(BvaCandidate), compare_bva_candidates);
+    for (int i = 0; i < order.size(); i++) enqueue(&w, order[i].lit);
+
+    for (int qi = 0; qi < w.queue.size() && w.budget > 0 && s->ok; qi++) {
+        Literal l = w.queue[qi];
+        w.queued[lit_index(l)] = 0;
+        if (s->val[lit_var(l)] != UNASSIGNED || s->eliminated[lit_var(l)]) continue;
+        if (s->occurs[lit_index(l)].size() < 3) continue;
+        if (last_hit - w.budget > lits * BVA_IDLE_PER_LIT) break;
+        int added = s->stats->bva_variables;
+        add_variables(s, l, &w);
+        if (s->stats->bva_variables > added) last_hit = w.budget;
+    }
+}
@@ -0,0 +1,114 @@
+#include "clause_exchange.h"
+
+ClauseExchange::ClauseExchange() : head_(0), sources_(0), deferred_(NULL), deferred_count_(NULL)
+{
+    for (int i = 0; i < EXCHANGE_CAPACITY; i++) {
+        slots_[i].seq.store(0, std::memory_order_relaxed);
+        slots_[i].from.store(-1, std::memory_order_relaxed);
+        slots_[i].size.store(0, std::memory_order_relaxed);
+        slots_[i].lbd.store(0, std::memory_order_relaxed);
+    }
+}
+
+ClauseExchange::~ClauseExchange()
+{
+    free(deferred_);
+    free(deferred_count_);
+}
+
+int ClauseExchange::defer(int sources)
+{
+    deferred_ = (DeferredClause*)malloc((size_t)sources * EXCHANGE_DEFERRED * sizeof(DeferredClause));
+    deferred_count_ = (int*)calloc((size_t)sources, sizeof(int));
+    if (!deferred_ || !deferred_count_) {
+        free(deferred_);
+        free(deferred_count_);
+        deferred_ = NULL;
+        deferred_count_ = NULL;
+        fprintf(stderr, "Memory Allocation Failed: ClauseExchange::defer\n");
+        return FALSE;
+    }
+    sources_ = sources;
+    return TRUE;
+}
+
+void ClauseExchange::flush_deferred()
+{
+    int sources = sources_;
+    sources_ = 0;
+    for (int from = 0; from < sources; from++) {
+        const DeferredClause* d = deferred_ + (size_t)from * EXCHANGE_DEFERRED;
+        for (int i = 0; i < deferred_count_[from]; i++) publish(from, d[i].lits, d[i].size, d[i].lbd);
+        deferred_count_[from] = 0;
+    }
+    sources_ = sources;
+}
+
+int ClauseExchange::publish(int from, const Literal* lits, int size, int lbd)
+{
+    if (size <= 0 || size > EXCHANGE_MAX_SIZE) return FALSE;
+    if (sources_ > 0 && from >= 0 && from < sources_) {
+        if (deferred_count_[from] == EXCHANGE_DEFERRED) return FALSE;
+        DeferredClause* d = deferred_ + (size_t)from * EXCHANGE_DEFERRED + deferred_count_[from]++;
+        d->size = size;
+        d->lbd = lbd;
+        for (int i = 0; i < size; i++) d->lits[i] = lits[i];
+        return TRUE;
+    }
+    unsigned long long pos = head_.fetch_add(1, std::memory_order_relaxed);
+    ExchangeSlot& s = slots_[pos & (EXCHANGE_CAPACITY - 1)];
+
+    // 上一轮的还在写, 或者更快的线程已经绕一圈写了更新的位置
+    unsigned long long old = s.seq.load(std::memory_order_relaxed);
+    if ((old & 1) || old >= 2 * pos + 1) return FALSE;
+    if (!s.seq.compare_exchange_strong(old, 2 * pos + 1, std::memory_order_relaxed)) return FALSE;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    s.from.store(from, std::memory_order_relaxed);
+    s.size.store(size, std::memory_order_relaxed);
+    s.lbd.store(lbd, std::memory_order_relaxed);
+    for (int i = 0; i < size; i++) s.lits[i].store(lits[i], std::memory_order_relaxed);
+    s.seq.store(2 * pos + 2, std::memory_order_release);
+    return TRUE;
+}
+
+unsigned long long ClauseExchange::start_cursor() const
+{
+    return head_.load(std::memory_order_acquire);
+}
+
+int ClauseExchange::fetch(unsigned long long* cursor, int self, Literal* lits, int* size, int* lbd,
+                          long long* missed)
+{
+    for (;;) {
+        unsigned long long head = head_.load(std::memory_order_acquire);
+        if (*cursor >= head) return FALSE;
+        // 落后超过一圈, 中间的已经被覆盖了
+        if (head - *cursor > EXCHANGE_CAPACITY) {
+            *missed += (long long)(head - EXCHANGE_CAPACITY - *cursor);
+            *cursor = head - EXCHANGE_CAPACITY;
+        }
+
+        unsigned long long pos = (*cursor)++;
+        ExchangeSlot& s = slots_[pos & (EXCHANGE_CAPACITY - 1)];
+        unsigned long long seq = s.seq.load(std::memory_order_acquire);
+        if (seq != 2 * pos + 2) {
+            (*missed)++;
+            continue;
+        }
+        int from = s.from.load(std::memory_order_relaxed);
+        int n = s.size.load(std::memory_order_relaxed);
+        int l = s.lbd.load(std::memory_order_relaxed);
+        if (n < 1 || n > EXCHANGE_MAX_SIZE) n = 0;
+        for (int i = 0; i < n; i++) lits[i] = s.lits[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) != seq || n == 0) {
+            (*missed)++;
+            continue;
+        }
+        if (from == self) continue;
+        *size = n;
+        *lbd = l;
+        return TRUE;
+    }
+}
@@ -0,0 +1,54 @@
+#include "clause_store.h"
+
+int build_clause_store(ClauseStore* store, const CNF* cnf)
+{
+    init_mem_tracker(&store->mem, 0);
+    store->num_vars = cnf->num_variables;
+    store->has_empty = FALSE;
+
+    MemScope scope(&store->mem);
+    try {
+        // mark: 1 正文字出现过, 2 负文字出现过
+        Vec<char> mark;
+        int total = 0;
+        for (int i = 0; i < cnf->clauses.size; i++) {
+            const LiteralArray* c = &cnf->clauses.data[i].literals;
+            total += c->size;
+            for (int k = 0; k < c->size; k++) {
+                Variable v = c->data[k] > 0 ? c->data[k] : -c->data[k];
+                if (v > store->num_vars) store->num_vars = v;
+            }
+        }
+        mark.grow_to(store->num_vars + 1, 0);
+        store->lits.reserve(total);
+        store->starts.reserve(cnf->clauses.size + 1);
+        store->starts.push(0);
+
+        for (int i = 0; i < cnf->clauses.size; i++) {
+            const LiteralArray* c = &cnf->clauses.data[i].literals;
+            int begin = store->lits.size();
+            int tautology = FALSE;
+            for (int k = 0; k < c->size && !tautology; k++) {
+                Literal l = c->data[k];
+                Variable v = l > 0 ? l : -l;
+                char m = (char)(l > 0 ? 1 : 2);
+                if (mark[v] == 0) {
+                    mark[v] = m;
+                    store->lits.push(l);
+                } else if (mark[v] != m) {
+                    tautology = TRUE;
+                }
+            }
+            for (int k = 0; k < c->size; k++) mark[c->data[k] > 0 ? c->data[k] : -c->data[k]] = 0;
+            if (tautology) {
+                store->lits.shrink(begin);
+                continue;
+            }
+            if (store->lits.size() == begin) store->has_empty = TRUE;
+            store->starts.push(store->lits.size());
+        }
+    } catch (const MemoryExhausted&) {
+        return FALSE;
+    }
+    return TRUE;
+}
@@ -0,0 +1,410 @@
+#include "cube.h"
+#include "occ_propagator.h"
+#include "trace.h"
+#include <mutex>
+#include <new>
+#include <thread>
+
+void init_cube_options(CubeOptions* options)
+{
+    options->depth = 8;
+    options->limit = 256;
+    options->threads = 0;
+}
+
+// =========== lookahead ===========
+// 只在切cube时用, 每个节点都从第0层重放一遍cube
+
+#define LOOKAHEAD_CANDIDATES 64     // 每个节点只试出现次数最多的这么多个变量
+
+// 在当前cube下选分支变量: 两边分别传播, 按两边赋值个数的乘积打分
+// 一边矛盾的(failed literal)直接把另一边追加进cube
+// 返回分支变量; 0 表示没有可分的变量了; -1 表示这个cube矛盾
+static Variable choose_branch(OccPropagator* la, Vec<Literal>& cube)
+{
+    for (;;) {
+        Variable best = 0;
+        double best_score = -1;
+        int forced = FALSE;
+        int tried = 0;
+        for (int i = 0; i < la->order.size() && tried < LOOKAHEAD_CANDIDATES; i++) {
+            Variable v = la->order[i];
+            if (la->val[v] != UNASSIGNED) continue;
+            tried++;
+            int base = la->trail.size();
+            int pos_ok = occ_assign(la, v);
+            int pos_count = la->trail.size() - base;
+            occ_backtrack(la, base);
+            int neg_ok = occ_assign(la, -v);
+            int neg_count = la->trail.size() - base;
+            occ_backtrack(la, base);
+
+            if (!pos_ok && !neg_ok) return -1;
+            if (!pos_ok || !neg_ok) {
+                Literal l = pos_ok ? v : -v;
+                cube.push(l);
+                if (!occ_assign(la, l)) return -1;
+                forced = TRUE;
+                continue;
+            }
+            double score = (double)pos_count * neg_count;
+            if (score > best_score) {
+                best_score = score;
+                best = v;
+            }
+        }
+        // 固定了新文字, 前面的打分作废, 重来一遍
+        if (!forced) return best;
+    }
+}
+
+typedef struct {
+    int start;      // 在 pool 里的位置
+    int size;
+    int depth;
+} CubeNode;
+
+// 宽度优先地切, 叶子放进 lits/starts(和 ClauseStore 一样首尾相接)
+static void make_cubes(OccPropagator* la, const CubeOptions* options, Vec<Literal>& lits, Vec<int>& starts,
+                       int* refuted)
+{
+    Vec<Literal> pool;
+    Vec<CubeNode> queue;
+    Vec<Literal> cube;
+    int head = 0;
+    CubeNode root = { 0, 0, 0 };
+    queue.push(root);
+    starts.push(0);
+
+    while (head < queue.size()) {
+        CubeNode node = queue[head++];
+        cube.clear();
+        for (int i = 0; i < node.size; i++) cube.push(pool[node.start + i]);
+
+        occ_backtrack(la, la->root);
+        int ok = TRUE;
+        for (int i = 0; i < cube.size() && ok; i++) ok = occ_assign(la, cube[i]);
+        if (!ok) {
+            (*refuted)++;
+            continue;
+        }
+
+        // 待定的节点(包括这一个)和已经定下的叶子加起来就是最终cube数的上界, 切一次多一个
+        int frontier = (starts.size() - 1) + (queue.size() - head) + 1;
+        Variable branch = 0;
+        if (node.depth < options->depth && frontier < options->limit) {
+            branch = choose_branch(la, cube);
+            if (branch < 0) {
+                (*refuted)++;
+                continue;
+            }
+        }
+        if (branch == 0) {
+            for (int i = 0; i < cube.size(); i++) lits.push(cube[i]);
+            starts.push(lits.size());
+            continue;
+        }
+        for (int side = 0; side < 2; side++) {
+            CubeNode child = { pool.size(), cube.size() + 1, node.depth + 1 };
+            for (int i = 0; i < cube.size(); i++) pool.push(cube[i]);
+            pool.push(side == 0 ? branch : -branch);
+            queue.push(child);
+        }
+    }
+}
+
+int split_cubes(const ClauseStore* store, const CubeOptions* options, Vec<Literal>& lits, Vec<int>& starts,
+                int* refuted)
+{
+    OccPropagator la;
+    if (!init_occ_propagator(&la, store)) return FALSE;
+    make_cubes(&la, options, lits, starts, refuted);
+    return TRUE;
+}
+
+// =========== 求解cube ===========
+
+// 每个线程一个: 自己从队尾取, 别人从队头偷
+struct WorkDeque {
+    std::mutex mutex;
+    Vec<int> items;
+    int head;
+};
+
+struct Conquer {
+    const ClauseStore* store;
+    const SolverConfig* config;
+    SolverBudget* budget;       // 所有线程共用, 从切cube之前开始算
+    const Vec<Literal>* lits;
+    const Vec<int>* starts;
+    int threads;
+    WorkDeque* deques;
+    double* cube_time;          // 按cube, 没解完的是 -1
+    double* busy;               // 按线程
+    int* steals;
+    SolverStats* stats;
+
+    std::mutex mutex;           // 保护下面几项
+    SolverEngine** engines;
+    int stopping;               // 有cube SAT了, 或者预算用完/被取消
+    SatResult result;
+    StopReason stop_reason;
+    Assignment* assignment;
+};
+
+static int take_cube(Conquer* cq, int self, int* stolen)
+{
+    {
+        WorkDeque& own = cq->deques[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.items.size() > own.head) {
+            int idx = own.items.last();
+            own.items.pop();
+            return idx;
+        }
+    }
+    for (int k = 1; k < cq->threads; k++) {
+        WorkDeque& victim = cq->deques[(self + k) % cq->threads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.items.size() > victim.head) {
+            *stolen = TRUE;
+            return victim.items[victim.head++];
+        }
+    }
+    return -1;
+}
+
+// 停下所有线程, 调用者持有 cq->mutex
+static void stop_all(Conquer* cq)
+{
+    cq->stopping = TRUE;
+    for (int i = 0; i < cq->threads; i++)
+        if (cq->engines[i]) cq->engines[i]->interrupt();
+}
+
+static void conquer_worker(Conquer* cq, int index)
+{
+    TRACE_THREAD_NAME("conquer", index);
+    SolverEngine* engine;
+    try {
+        engine = create_solver_engine(cq->config);
+    } catch (const std::bad_alloc&) {
+        // 这个线程的cube会被别人偷走; 都失败的话结果是UNKNOWN
+        return;
+    }
+    engine->share_budget(cq->budget);
+    {
+        std::lock_guard<std::mutex> lock(cq->mutex);
+        cq->engines[index] = engine;
+        if (cq->stopping) engine->interrupt();
+    }
+    const ClauseStore* store = cq->store;
+    for (int i = 0; i < store->num_clauses(); i++)
+        if (!engine->add_shared_clause(store->clause(i), store->clause_size(i))) break;
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(cq->mutex);
+            if (cq->stopping) break;
+        }
+        int stolen = FALSE;
+        int idx;
+        {
+            TRACE_SCOPE("take cube");
+            idx = take_cube(cq, index, &stolen);
+        }
+        if (idx < 0) break;
+        if (stolen) cq->steals[index]++;
+
+        const Literal* cube = cq->lits->data() + (*cq->starts)[idx];
+        int size = (*cq->starts)[idx + 1] - (*cq->starts)[idx];
+        double t0 = solver_wall_seconds();
+        SatResult r;
+        {
+            TRACE_SCOPE("cube");
+            r = engine->solve(cube, size);
+        }
+        double t = solver_wall_seconds() - t0;
+        cq->busy[index] += t;
+
+        if (r == UNSAT) {
+            cq->cube_time[idx] = t;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(cq->mutex);
+        if (r == SAT) {
+            cq->cube_time[idx] = t;
+            if (cq->result != SAT) {
+                cq->result = SAT;
+                Assignment* a = cq->assignment;
+                for (int v = 1; v <= a->size; v++) a->values[v] = engine->model_value(v);
+            }
+        } else if (!cq->stopping) {
+            cq->stop_reason = engine->stats().stop_reason;
+        }
+        stop_all(cq);
+        break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cq->mutex);
+        cq->engines[index] = NULL;
+        cq->stats[index] = engine->stats();
+    }
+    delete engine;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// 各线程的统计加起来
+static void sum_stats(const SolverStats* parts, int count, SolverStats* out)
+{
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < count; i++) {
+        const SolverStats* s = &parts[i];
+        out->decisions += s->decisions;
+        out->propagations += s->propagations;
+        out->conflicts += s->conflicts;
+        out->restarts += s->restarts;
+        out->learned_clauses += s->learned_clauses;
+        out->learned_literals += s->learned_literals;
+        out->minimized_literals += s->minimized_literals;
+        out->vivified_clauses += s->vivified_clauses;
+        out->deleted_clauses += s->deleted_clauses;
+        for (int t = 0; t < INPROCESS_COUNT; t++) {
+            out->inprocess[t].calls += s->inprocess[t].calls;
+            out->inprocess[t].seconds += s->inprocess[t].seconds;
+            out->inprocess[t].clauses += s->inprocess[t].clauses;
+            out->inprocess[t].literals += s->inprocess[t].literals;
+            out->inprocess[t].variables += s->inprocess[t].variables;
+        }
+        if (s->max_level > out->max_level) out->max_level = s->max_level;
+        if (s->memory.peak_total > out->memory.peak_total) out->memory = s->memory;
+    }
+}
+
+SatResult cube_and_conquer(const CNF* cnf, Assignment* assignment, const SolverConfig* config,
+                           const CubeOptions* options, CubeResult* result)
+{
+    int threads = options->threads;
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    CubeResult local;
+    if (!result) result = &local;
+    memset(result, 0, sizeof(*result));
+    result->threads = threads;
+    SolverBudget budget;
+    init_solver_budget(&budget, config);
+
+    ClauseStore store;
+    if (!build_clause_store(&store, cnf)) {
+        result->stats.stop_reason = STOP_MEMORY;
+        return UNKNOWN;
+    }
+
+    // cube 和 lookahead 的数组都记在子句库的账上
+    MemScope scope(&store.mem);
+    SatResult answer = UNKNOWN;
+    Vec<Literal> lits;
+    Vec<int> starts;
+    try {
+        double t0 = solver_wall_seconds();
+        int ok = split_cubes(&store, options, lits, starts, &result->refuted);
+        result->lookahead_seconds = solver_wall_seconds() - t0;
+        if (!ok) return UNSAT;
+    } catch (const MemoryExhausted&) {
+        result->stats.stop_reason = STOP_MEMORY;
+        return UNKNOWN;
+    }
+    int cubes = starts.size() - 1;
+    result->cubes = cubes;
+    if (cubes == 0) return UNSAT;
+
+    Conquer cq;
+    cq.store = &store;
+    cq.config = config;
+    cq.budget = &budget;
+    cq.lits = &lits;
+    cq.starts = &starts;
+    cq.threads = threads;
+    cq.stopping = FALSE;
+    cq.result = UNKNOWN;
+    cq.stop_reason = STOP_NONE;
+    cq.assignment = assignment;
+    cq.deques = new (std::nothrow) WorkDeque[threads];
+    cq.cube_time = new (std::nothrow) double[cubes];
+    cq.busy = new (std::nothrow) double[threads];
+    cq.steals = new (std::nothrow) int[threads];
+    cq.stats = new (std::nothrow) SolverStats[threads];
+    cq.engines = new (std::nothrow) SolverEngine*[threads];
+    std::thread* workers = new (std::nothrow) std::thread[threads];
+    int ok = cq.deques && cq.cube_time && cq.busy && cq.steals && cq.stats && cq.engines && workers;
+    try {
+        for (int i = 0; ok && i < threads; i++) {
+            // 按顺序分成连续的几段, 相邻的cube难度接近, 靠偷来平衡
+            cq.deques[i].head = 0;
+            for (int k = (int)((long long)cubes * i / threads); k < (int)((long long)cubes * (i + 1) / threads); k++)
+                cq.deques[i].items.push(k);
+        }
+    } catch (const MemoryExhausted&) {
+        ok = FALSE;
+    }
+    if (!ok) {
+        fprintf(stderr, "Memory Allocation Failed: cube_and_conquer\n");
+        result->stats.stop_reason = STOP_MEMORY;
+    } else {
+        for (int k = 0; k < cubes; k++) cq.cube_time[k] = -1;
+        for (int i = 0; i < threads; i++) {
+            cq.busy[i] = 0;
+            cq.steals[i] = 0;
+            cq.engines[i] = NULL;
+            memset(&cq.stats[i], 0, sizeof(SolverStats));
+        }
+
+        double t0 = solver_wall_seconds();
+        for (int i = 0; i < threads; i++) workers[i] = std::thread(conquer_worker, &cq, i);
+        for (int i = 0; i < threads; i++) workers[i].join();
+        result->conquer_seconds = solver_wall_seconds() - t0;
+
+        // 汇总
+        sum_stats(cq.stats, threads, &result->stats);
+        double busy = 0;
+        for (int i = 0; i < threads; i++) {
+            busy += cq.busy[i];
+            result->steals += cq.steals[i];
+        }
+        if (result->conquer_seconds > 0) result->efficiency = busy / (threads * result->conquer_seconds);
+        int n = 0;
+        double sum = 0;
+        for (int k = 0; k < cubes; k++) {
+            if (cq.cube_time[k] < 0) continue;
+            cq.cube_time[n++] = cq.cube_time[k];
+            sum += cq.cube_time[k];
+        }
+        result->solved = n;
+        if (n > 0) {
+            qsort(cq.cube_time, n, sizeof(double), compare_double);
+            result->cube_min = cq.cube_time[0];
+            result->cube_max = cq.cube_time[n - 1];
+            result->cube_median = cq.cube_time[n / 2];
+            result->cube_mean = sum / n;
+        }
+
+        if (cq.result == SAT) answer = SAT;
+        else if (n == cubes) answer = UNSAT;
+        else result->stats.stop_reason = cq.stop_reason != STOP_NONE ? cq.stop_reason : STOP_MEMORY;
+    }
+
+    delete[] workers;
+    delete[] cq.deques;
+    delete[] cq.cube_time;
+    delete[] cq.busy;
+    delete[] cq.steals;
+    delete[] cq.stats;
+    delete[] cq.engines;
+    return answer;
+}
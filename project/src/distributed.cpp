@@ -0,0 +1,668 @@
+#include "distributed.h"
+#include "clause_exchange.h"
+#include "portfolio.h"
+#include <mutex>
+#include <new>
+#include <thread>
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+void init_distributed_options(DistributedOptions* options)
+{
+    options->workers = 0;
+    options->cube = FALSE;
+    init_cube_options(&options->cube_options);
+    options->worker_command = NULL;
+}
+
+// =========== 消息内容 ===========
+
+static void put_work(WireMessage* msg, int id, const SolverConfig* config, const Literal* cube, int size)
+{
+    wire_begin(msg, WIRE_WORK);
+    wire_put(msg, id);
+    wire_put(msg, config->heuristic);
+    wire_put(msg, config->propagation);
+    wire_put(msg, config->restart);
+    wire_put(msg, config->phase);
+    wire_put(msg, (int)config->seed);
+    wire_put64(msg, config->mem_limit);
+    wire_put64(msg, (long long)(config->time_limit * 1000));
+    wire_put64(msg, config->conflict_limit);
+    wire_put64(msg, config->decision_limit);
+    wire_put64(msg, config->propagation_limit);
+    wire_put(msg, config->share_lbd);
+    wire_put(msg, config->share_max_size);
+    wire_put(msg, config->share_rate);
+    wire_put64(msg, config->inprocess_interval);
+    wire_put(msg, config->inprocess_mask);
+    wire_put(msg, config->inprocess_effort);
+    wire_put(msg, size);
+    for (int i = 0; i < size; i++) wire_put(msg, cube[i]);
+}
+
+static int get_work(WireMessage* msg, int* id, SolverConfig* config, Vec<Literal>& cube)
+{
+    int heuristic, propagation, restart, phase, seed, size;
+    long long time_ms;
+    init_solver_config(config);
+    if (!wire_get(msg, id) || !wire_get(msg, &heuristic) || !wire_get(msg, &propagation) ||
+        !wire_get(msg, &restart) || !wire_get(msg, &phase) || !wire_get(msg, &seed) ||
+        !wire_get64(msg, &config->mem_limit) || !wire_get64(msg, &time_ms) ||
+        !wire_get64(msg, &config->conflict_limit) || !wire_get64(msg, &config->decision_limit) ||
+        !wire_get64(msg, &config->propagation_limit) || !wire_get(msg, &config->share_lbd) ||
+        !wire_get(msg, &config->share_max_size) || !wire_get(msg, &config->share_rate) ||
+        !wire_get64(msg, &config->inprocess_interval) || !wire_get(msg, &config->inprocess_mask) ||
+        !wire_get(msg, &config->inprocess_effort) || !wire_get(msg, &size))
+        return FALSE;
+    if (heuristic < 0 || heuristic >= HEURISTIC_COUNT || propagation < 0 || propagation >= PROPAGATION_COUNT ||
+        restart < 0 || restart >= RESTART_COUNT || phase < 0 || phase >= PHASE_COUNT || size < 0)
+        return FALSE;
+    config->heuristic = (HeuristicKind)heuristic;
+    config->propagation = (PropagationKind)propagation;
+    config->restart = (RestartKind)restart;
+    config->phase = (PhaseKind)phase;
+    config->seed = (unsigned int)seed;
+    config->time_limit = time_ms / 1000.0;
+    cube.clear();
+    for (int i = 0; i < size; i++) {
+        Literal l;
+        if (!wire_get(msg, &l) || l == 0) return FALSE;
+        cube.push(l);
+    }
+    return TRUE;
+}
+
+static void put_formula(WireMessage* msg, const ClauseStore* store)
+{
+    wire_begin(msg, WIRE_FORMULA);
+    wire_put(msg, store->num_vars);
+    wire_put(msg, store->num_clauses() + (store->has_empty ? 1 : 0));
+    if (store->has_empty) wire_put(msg, 0);
+    for (int i = 0; i < store->num_clauses(); i++) {
+        wire_put(msg, store->clause_size(i));
+        for (int k = 0; k < store->clause_size(i); k++) wire_put(msg, store->clause(i)[k]);
+    }
+}
+
+// 直接填进子句库, 调用者负责 MemScope
+static int get_formula(WireMessage* msg, ClauseStore* store)
+{
+    int num_vars, num_clauses;
+    if (!wire_get(msg, &num_vars) || !wire_get(msg, &num_clauses) || num_vars < 0 || num_clauses < 0) return FALSE;
+    store->lits.clear();
+    store->starts.clear();
+    store->starts.push(0);
+    store->num_vars = num_vars;
+    store->has_empty = FALSE;
+    for (int i = 0; i < num_clauses; i++) {
+        int size;
+        if (!wire_get(msg, &size) || size < 0) return FALSE;
+        if (size == 0) store->has_empty = TRUE;
+        for (int k = 0; k < size; k++) {
+            Literal l;
+            if (!wire_get(msg, &l) || l == 0 || l > num_vars || -l > num_vars) return FALSE;
+            store->lits.push(l);
+        }
+        if (size > 0) store->starts.push(store->lits.size());
+    }
+    return TRUE;
+}
+
+// =========== 工作进程 ===========
+
+struct WorkerContext {
+    WireChannel* channel;
+    std::mutex send_mutex;          // 收消息的线程和求解线程都会发
+    ClauseStore store;
+    ClauseExchange* exchange;       // 本进程的求解器和外面交换子句, 外面来的记成 -1 号
+    unsigned long long drain_cursor;
+
+    std::mutex engine_mutex;        // 保护 engine 和 solving
+    SolverEngine* engine;
+    SolverConfig engine_config;     // engine 建的时候用的配置
+    int solving;
+
+    int work_id;
+    SolverConfig work_config;
+    SolverBudget budget;            // 这个WORK的预算, 协调进程发来的是总预算还剩下的
+    Vec<Literal> cube;
+};
+
+static int worker_send(WorkerContext* ctx, const WireMessage* msg)
+{
+    std::lock_guard<std::mutex> lock(ctx->send_mutex);
+    return wire_send(ctx->channel, msg);
+}
+
+// 把求解器导出的单元/二元子句发给协调进程; 挂在进度回调上, 在求解线程里跑
+static void drain_exports(const SolverStats*, void* user)
+{
+    WorkerContext* ctx = (WorkerContext*)user;
+    if (!ctx->exchange) return;
+    Literal lits[EXCHANGE_MAX_SIZE];
+    int size, lbd;
+    long long missed = 0;
+    WireMessage msg;
+    try {
+        while (ctx->exchange->fetch(&ctx->drain_cursor, -1, lits, &size, &lbd, &missed)) {
+            if (size > 2) continue;
+            wire_begin(&msg, WIRE_CLAUSE);
+            wire_put(&msg, size);
+            for (int i = 0; i < size; i++) wire_put(&msg, lits[i]);
+            worker_send(ctx, &msg);
+        }
+    } catch (const MemoryExhausted&) {
+        // 少发几个子句不影响正确性
+    }
+}
+
+// 求解器的配置除了预算都一样时可以接着用, 学习子句都留着; 预算走 ctx->budget
+static int same_work_config(const SolverConfig* a, const SolverConfig* b)
+{
+    return a->heuristic == b->heuristic && a->propagation == b->propagation && a->restart == b->restart &&
+           a->phase == b->phase && a->seed == b->seed && a->mem_limit == b->mem_limit &&
+           a->share_lbd == b->share_lbd && a->share_max_size == b->share_max_size &&
+           a->share_rate == b->share_rate && a->inprocess_interval == b->inprocess_interval &&
+           a->inprocess_mask == b->inprocess_mask && a->inprocess_effort == b->inprocess_effort;
+}
+
+static void solve_work(WorkerContext* ctx)
+{
+    SatResult result = UNKNOWN;
+    SolverStats before, after;
+    memset(&before, 0, sizeof(before));
+    memset(&after, 0, sizeof(after));
+    after.stop_reason = STOP_MEMORY;
+    try {
+        if (!ctx->engine || !same_work_config(&ctx->engine_config, &ctx->work_config)) {
+            SolverEngine* old;
+            {
+                std::lock_guard<std::mutex> lock(ctx->engine_mutex);
+                old = ctx->engine;
+                ctx->engine = NULL;
+            }
+            delete old;
+            SolverConfig config = ctx->work_config;
+            config.progress = drain_exports;
+            config.progress_user = ctx;
+            config.progress_interval = 0.05;
+            SolverEngine* engine = create_solver_engine(&config);
+            if (ctx->exchange && config.share_lbd > 0) engine->connect_exchange(ctx->exchange, 0);
+            engine->share_budget(&ctx->budget);
+            const ClauseStore* store = &ctx->store;
+            if (store->has_empty) engine->add_clause(NULL, 0);
+            for (int i = 0; i < store->num_clauses(); i++)
+                if (!engine->add_shared_clause(store->clause(i), store->clause_size(i))) break;
+            ctx->engine_config = ctx->work_config;
+            std::lock_guard<std::mutex> lock(ctx->engine_mutex);
+            ctx->engine = engine;
+        }
+        init_solver_budget(&ctx->budget, &ctx->work_config);
+        before = ctx->engine->stats();
+        result = ctx->engine->solve(ctx->cube.data(), ctx->cube.size());
+        after = ctx->engine->stats();
+    } catch (const std::bad_alloc&) {
+        result = UNKNOWN;
+    }
+    drain_exports(NULL, ctx);
+
+    WireMessage msg;
+    try {
+        wire_begin(&msg, WIRE_RESULT);
+        wire_put(&msg, ctx->work_id);
+        wire_put(&msg, result);
+        wire_put(&msg, result == UNKNOWN ? after.stop_reason : STOP_NONE);
+        wire_put64(&msg, after.decisions - before.decisions);
+        wire_put64(&msg, after.propagations - before.propagations);
+        wire_put64(&msg, after.conflicts - before.conflicts);
+        if (result == SAT) {
+            int n = ctx->store.num_vars;
+            wire_put(&msg, n);
+            for (int base = 0; base <= n; base += 32) {
+                unsigned int word = 0;
+                for (int b = 0; b < 32 && base + b <= n; b++)
+                    if (base + b > 0 && ctx->engine->model_value(base + b) == TRUE) word |= 1u << b;
+                wire_put(&msg, (int)word);
+            }
+        }
+        worker_send(ctx, &msg);
+    } catch (const MemoryExhausted&) {
+        fprintf(stderr, "Memory Allocation Failed: worker result\n");
+    }
+    std::lock_guard<std::mutex> lock(ctx->engine_mutex);
+    ctx->solving = FALSE;
+}
+
+int run_worker(WireChannel* channel)
+{
+    WorkerContext ctx;
+    ctx.channel = channel;
+    init_mem_tracker(&ctx.store.mem, 0);
+    ctx.store.num_vars = 0;
+    ctx.store.has_empty = FALSE;
+    ctx.exchange = new (std::nothrow) ClauseExchange;
+    ctx.drain_cursor = ctx.exchange ? ctx.exchange->start_cursor() : 0;
+    ctx.engine = NULL;
+    init_solver_config(&ctx.engine_config);
+    ctx.solving = FALSE;
+    ctx.work_id = 0;
+    init_solver_config(&ctx.work_config);
+
+    std::thread solver;
+    int code = 0;
+    try {
+        WireMessage msg;
+        wire_begin(&msg, WIRE_HELLO);
+        wire_put(&msg, WIRE_VERSION);
+        if (!worker_send(&ctx, &msg)) code = 1;
+
+        while (code == 0 && wire_recv(channel, &msg)) {
+            if (msg.type == WIRE_QUIT) break;
+            if (msg.type == WIRE_STOP) {
+                std::lock_guard<std::mutex> lock(ctx.engine_mutex);
+                if (ctx.solving && ctx.engine) ctx.engine->interrupt();
+            } else if (msg.type == WIRE_FORMULA || msg.type == WIRE_WORK) {
+                // 协调进程收到RESULT以后才会发下一个, 这时求解线程已经发完结果正在退出
+                if (solver.joinable()) solver.join();
+                if (msg.type == WIRE_FORMULA) {
+                    delete ctx.engine;
+                    ctx.engine = NULL;
+                    MemScope scope(&ctx.store.mem);
+                    if (!get_formula(&msg, &ctx.store)) code = 1;
+                } else if (!get_work(&msg, &ctx.work_id, &ctx.work_config, ctx.cube)) {
+                    code = 1;
+                } else {
+                    ctx.solving = TRUE;
+                    solver = std::thread(solve_work, &ctx);
+                }
+            } else if (msg.type == WIRE_CLAUSE && ctx.exchange) {
+                int size;
+                Literal lits[EXCHANGE_MAX_SIZE];
+                if (!wire_get(&msg, &size) || size < 1 || size > EXCHANGE_MAX_SIZE) continue;
+                int ok = TRUE;
+                for (int i = 0; i < size && ok; i++) ok = wire_get(&msg, &lits[i]) && lits[i] != 0;
+                if (ok) ctx.exchange->publish(-1, lits, size, size);
+            }
+        }
+    } catch (const MemoryExhausted&) {
+        code = 1;
+    }
+    if (code != 0) fprintf(stderr, "Worker: protocol error or out of memory\n");
+
+    {
+        std::lock_guard<std::mutex> lock(ctx.engine_mutex);
+        if (ctx.solving && ctx.engine) ctx.engine->interrupt();
+    }
+    if (solver.joinable()) solver.join();
+    delete ctx.engine;
+    delete ctx.exchange;
+    return code;
+}
+
+int run_stdio_worker(void)
+{
+#ifdef __linux__
+    // Ctrl-C 由协调进程处理, 它会发 STOP/QUIT
+    signal(SIGINT, SIG_IGN);
+    int out = dup(1);
+    if (out < 0 || dup2(2, 1) < 0) {
+        fprintf(stderr, "Worker: cannot set up stdout\n");
+        return 1;
+    }
+    WireFds fds = { 0, out };
+    WireChannel channel;
+    wire_fd_channel(&channel, &fds);
+    return run_worker(&channel);
+#else
+    fprintf(stderr, "Worker mode is only supported on Linux\n");
+    return 1;
+#endif
+}
+
+// =========== 协调进程 ===========
+
+#ifdef __linux__
+
+struct RemoteWorker {
+    pid_t pid;
+    WireFds fds;            // socketpair 的一端, 读写同一个fd
+    WireChannel channel;
+    int alive;
+    int item;               // 正在跑的工作, -1 表示空闲
+};
+
+static int spawn_worker(RemoteWorker* w, const char* command)
+{
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return FALSE;
+    // 协调进程这一端不能漏给后面启动的工作进程, 否则对方退出时这边收不到EOF
+    fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(sv[0]);
+        close(sv[1]);
+        return FALSE;
+    }
+    if (pid == 0) {
+        dup2(sv[1], 0);
+        dup2(sv[1], 1);
+        if (sv[1] > 1) close(sv[1]);
+        if (command) execl("/bin/sh", "sh", "-c", command, (char*)NULL);
+        else execl("/proc/self/exe", "sat_solver", "--worker", (char*)NULL);
+        _exit(127);
+    }
+    close(sv[1]);
+    w->pid = pid;
+    w->fds.in_fd = sv[0];
+    w->fds.out_fd = sv[0];
+    wire_fd_channel(&w->channel, &w->fds);
+    w->alive = TRUE;
+    w->item = -1;
+    return TRUE;
+}
+
+static void close_worker(RemoteWorker* w)
+{
+    if (w->fds.in_fd >= 0) close(w->fds.in_fd);
+    w->fds.in_fd = w->fds.out_fd = -1;
+    w->alive = FALSE;
+}
+
+// 工作的状态
+#define ITEM_PENDING 0
+#define ITEM_RUNNING 1
+#define ITEM_DONE 2
+
+struct Coordinator {
+    const SolverConfig* config;
+    double deadline;        // 整个求解的截止时刻, 0 表示不限
+    int cube_mode;
+    const Vec<Literal>* cube_lits;
+    const Vec<int>* cube_starts;
+    RemoteWorker* workers;
+    int count;
+    Vec<char> state;        // 按工作
+    DistributedResult* result;
+};
+
+static void lose_worker(Coordinator* co, RemoteWorker* w)
+{
+    if (w->item >= 0) co->state[w->item] = ITEM_PENDING;
+    w->item = -1;
+    close_worker(w);
+    co->result->lost++;
+}
+
+// 总预算还剩多少: 时间按协调进程的截止时刻, 计数是已经回来的结果加起来的
+// 用完了返回原因; config 不为NULL时把剩下的填进去
+static StopReason remaining_budget(Coordinator* co, SolverConfig* config)
+{
+    const SolverConfig* total = co->config;
+    const SolverStats* used = &co->result->stats;
+    double left = co->deadline > 0 ? co->deadline - solver_wall_seconds() : 0;
+    // WORK 里的时间按毫秒发, 不到1毫秒会变成0(不限)
+    if (co->deadline > 0 && left < 0.001) return STOP_TIME;
+    if (total->conflict_limit > 0 && used->conflicts >= total->conflict_limit) return STOP_CONFLICTS;
+    if (total->decision_limit > 0 && used->decisions >= total->decision_limit) return STOP_DECISIONS;
+    if (total->propagation_limit > 0 && used->propagations >= total->propagation_limit) return STOP_PROPAGATIONS;
+    if (config) {
+        if (co->deadline > 0) config->time_limit = left;
+        if (total->conflict_limit > 0) config->conflict_limit = total->conflict_limit - used->conflicts;
+        if (total->decision_limit > 0) config->decision_limit = total->decision_limit - used->decisions;
+        if (total->propagation_limit > 0) config->propagation_limit = total->propagation_limit - used->propagations;
+    }
+    return STOP_NONE;
+}
+
+// 空闲的工作进程各领一个还没做的工作, 预算是总预算还剩下的
+static void dispatch(Coordinator* co)
+{
+    WireMessage msg;
+    int next = 0;
+    for (int i = 0; i < co->count; i++) {
+        RemoteWorker* w = &co->workers[i];
+        if (!w->alive || w->item >= 0) continue;
+        while (next < co->state.size() && co->state[next] != ITEM_PENDING) next++;
+        if (next == co->state.size()) return;
+
+        SolverConfig config;
+        if (co->cube_mode) config = *co->config;
+        else portfolio_config(co->config, next, &config);
+        if (remaining_budget(co, &config) != STOP_NONE) return;
+        int begin = (*co->cube_starts)[next];
+        put_work(&msg, next, &config, co->cube_lits->data() + begin, (*co->cube_starts)[next + 1] - begin);
+        if (!wire_send(&w->channel, &msg)) {
+            lose_worker(co, w);
+            continue;
+        }
+        w->item = next;
+        co->state[next] = ITEM_RUNNING;
+    }
+}
+
+static int decode_model(WireMessage* msg, Assignment* assignment)
+{
+    int n;
+    if (!wire_get(msg, &n) || n < 0) return FALSE;
+    for (Variable v = 1; v <= assignment->size; v++) assignment->values[v] = FALSE;
+    for (int base = 0; base <= n; base += 32) {
+        int word;
+        if (!wire_get(msg, &word)) return FALSE;
+        for (int b = 0; b < 32 && base + b <= n; b++)
+            if (base + b > 0 && base + b <= assignment->size && ((unsigned int)word >> b) & 1u)
+                assignment->values[base + b] = TRUE;
+    }
+    return TRUE;
+}
+
+#endif // __linux__
+
+SatResult distributed_solve(const CNF* cnf, Assignment* assignment, const SolverConfig* config,
+                            const DistributedOptions* options, DistributedResult* result)
+{
+    DistributedResult local;
+    if (!result) result = &local;
+    memset(result, 0, sizeof(*result));
+#ifndef __linux__
+    (void)cnf;
+    (void)assignment;
+    (void)config;
+    (void)options;
+    fprintf(stderr, "Distributed mode is only supported on Linux\n");
+    result->stats.stop_reason = STOP_WORKER_LOST;
+    return UNKNOWN;
+#else
+    double start = solver_wall_seconds();
+    int count = options->workers;
+    if (count <= 0) count = (int)std::thread::hardware_concurrency();
+    if (count <= 0) count = 1;
+
+    ClauseStore store;
+    if (!build_clause_store(&store, cnf)) {
+        result->stats.stop_reason = STOP_MEMORY;
+        return UNKNOWN;
+    }
+    MemScope scope(&store.mem);
+    Vec<Literal> cube_lits;
+    Vec<int> cube_starts;
+    Coordinator co;
+    WireMessage msg;
+    try {
+        if (options->cube) {
+            if (!split_cubes(&store, &options->cube_options, cube_lits, cube_starts, &result->refuted)) return UNSAT;
+        } else {
+            // portfolio: 每个进程一个配置, 都不带假设
+            cube_starts.grow_to(count + 1, 0);
+        }
+        co.state.grow_to(cube_starts.size() - 1, (char)ITEM_PENDING);
+        put_formula(&msg, &store);
+    } catch (const MemoryExhausted&) {
+        result->stats.stop_reason = STOP_MEMORY;
+        return UNKNOWN;
+    }
+    int items = cube_starts.size() - 1;
+    result->work_items = items;
+    if (items == 0) return UNSAT;
+
+    co.config = config;
+    co.deadline = config->time_limit > 0 ? start + config->time_limit : 0;
+    co.cube_mode = options->cube;
+    co.cube_lits = &cube_lits;
+    co.cube_starts = &cube_starts;
+    co.count = count;
+    co.result = result;
+    co.workers = new (std::nothrow) RemoteWorker[count];
+    struct pollfd* fds = new (std::nothrow) struct pollfd[count];
+    RemoteWorker** polled = new (std::nothrow) RemoteWorker*[count];
+    if (!co.workers || !fds || !polled) {
+        fprintf(stderr, "Memory Allocation Failed: distributed_solve\n");
+        delete[] co.workers;
+        delete[] fds;
+        delete[] polled;
+        result->stats.stop_reason = STOP_MEMORY;
+        return UNKNOWN;
+    }
+
+    fflush(stdout);
+    for (int i = 0; i < count; i++) {
+        RemoteWorker* w = &co.workers[i];
+        memset(w, 0, sizeof(*w));
+        w->fds.in_fd = w->fds.out_fd = -1;
+        w->item = -1;
+        if (!spawn_worker(w, options->worker_command)) {
+            fprintf(stderr, "Failed to start worker %d\n", i);
+            continue;
+        }
+        // 握手, 然后发公式
+        WireMessage hello;
+        int version = 0;
+        if (!wire_recv(&w->channel, &hello) || hello.type != WIRE_HELLO || !wire_get(&hello, &version) ||
+            version != WIRE_VERSION || !wire_send(&w->channel, &msg)) {
+            fprintf(stderr, "Worker %d failed the handshake\n", i);
+            close_worker(w);
+            continue;
+        }
+        result->workers++;
+    }
+
+    SatResult answer = UNKNOWN;
+    StopReason reason = STOP_NONE;
+    StopReason worker_reason = STOP_NONE;  // portfolio模式下第一个没解完的工作为什么停
+    try {
+        for (;;) {
+            if (cancel_requested()) {
+                reason = STOP_CANCELLED;
+                break;
+            }
+            reason = remaining_budget(&co, NULL);
+            if (reason != STOP_NONE) break;
+            dispatch(&co);
+            int polls = 0, busy = 0, pending = 0;
+            for (int i = 0; i < items; i++) pending += co.state[i] == ITEM_PENDING;
+            for (int i = 0; i < count; i++) {
+                RemoteWorker* w = &co.workers[i];
+                if (!w->alive) continue;
+                if (w->item >= 0) busy++;
+                fds[polls].fd = w->fds.in_fd;
+                fds[polls].events = POLLIN;
+                fds[polls].revents = 0;
+                polled[polls++] = w;
+            }
+            if (polls == 0) {
+                reason = STOP_WORKER_LOST;
+                break;
+            }
+            if (busy == 0 && pending == 0) {
+                // 都做完了: cube模式下全部UNSAT才会走到这里; portfolio模式是全都UNKNOWN
+                if (co.cube_mode && result->completed == items) answer = UNSAT;
+                else if (reason == STOP_NONE) reason = worker_reason != STOP_NONE ? worker_reason : STOP_CANCELLED;
+                break;
+            }
+            if (poll(fds, polls, 100) <= 0) continue;
+
+            for (int p = 0; p < polls && answer == UNKNOWN && reason == STOP_NONE; p++) {
+                if (!fds[p].revents) continue;
+                RemoteWorker* w = polled[p];
+                if (!wire_recv(&w->channel, &msg)) {
+                    lose_worker(&co, w);
+                    continue;
+                }
+                if (msg.type == WIRE_CLAUSE) {
+                    for (int i = 0; i < count; i++) {
+                        RemoteWorker* other = &co.workers[i];
+                        if (other == w || !other->alive) continue;
+                        if (wire_send(&other->channel, &msg)) result->clauses_forwarded++;
+                        else lose_worker(&co, other);
+                    }
+                    continue;
+                }
+                if (msg.type != WIRE_RESULT) continue;
+
+                int id, r, stop;
+                long long decisions, propagations, conflicts;
+                if (!wire_get(&msg, &id) || !wire_get(&msg, &r) || !wire_get(&msg, &stop) ||
+                    !wire_get64(&msg, &decisions) || !wire_get64(&msg, &propagations) ||
+                    !wire_get64(&msg, &conflicts) || id != w->item) {
+                    lose_worker(&co, w);
+                    continue;
+                }
+                w->item = -1;
+                co.state[id] = ITEM_DONE;
+                result->completed++;
+                result->stats.decisions += decisions;
+                result->stats.propagations += propagations;
+                result->stats.conflicts += conflicts;
+                if (r == SAT) {
+                    if (decode_model(&msg, assignment)) answer = SAT;
+                    else lose_worker(&co, w);
+                } else if (r == UNSAT) {
+                    // 不带假设的UNSAT就是整个公式UNSAT
+                    if (!co.cube_mode) answer = UNSAT;
+                } else {
+                    StopReason why = stop > STOP_NONE && stop < STOP_REASON_COUNT ? (StopReason)stop : STOP_CANCELLED;
+                    // 有一个cube没解完, 整体就不可能是UNSAT了; portfolio要等别的配置
+                    if (co.cube_mode) reason = why;
+                    else if (worker_reason == STOP_NONE) worker_reason = why;
+                }
+            }
+            if (answer != UNKNOWN || reason != STOP_NONE) break;
+        }
+    } catch (const MemoryExhausted&) {
+        reason = STOP_MEMORY;
+    }
+
+    // 收尾: 让还在跑的停下并退出
+    WireMessage bye;
+    try {
+        for (int i = 0; i < count; i++) {
+            RemoteWorker* w = &co.workers[i];
+            if (!w->alive) continue;
+            wire_begin(&bye, WIRE_STOP);
+            wire_send(&w->channel, &bye);
+            wire_begin(&bye, WIRE_QUIT);
+            wire_send(&w->channel, &bye);
+        }
+    } catch (const MemoryExhausted&) {
+    }
+    for (int i = 0; i < count; i++) {
+        RemoteWorker* w = &co.workers[i];
+        result->bytes_sent += w->channel.bytes_out;
+        result->bytes_received += w->channel.bytes_in;
+        if (w->alive) close_worker(w);
+        if (w->fds.in_fd == -1 && w->pid > 0) waitpid(w->pid, NULL, 0);
+    }
+    result->stats.stop_reason = answer == UNKNOWN ? reason : STOP_NONE;
+
+    delete[] co.workers;
+    delete[] fds;
+    delete[] polled;
+    return answer;
+#endif
+}
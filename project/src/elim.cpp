@@ -0,0 +1,207 @@
+#include "simplifier.h"
+
+// =========== 变量消元 ===========
+// SatELite: 变量v的正负子句两两做resolution, 非重言式的resolvent不比原来的子句多
+// 就用resolvent替换掉所有含v的子句. 按代价(正负出现次数之积)从小到大试,
+// 出现次数为0的一边就是纯文字, 代价为0最先消.
+// v 是某个门的输出时(gates.cpp), 门子句之间的resolvent是重言式, 非门子句之间的
+// resolvent可以由门子句和非门子句的resolvent推出, 两种都不用算(Een & Biere 2005)
+
+// ---------- 按代价的小根堆 ----------
+// 代价随着子句增删两个方向都会变, 所以 update 既能上浮也能下沉
+struct ElimHeap {
+    Vec<long long, MEM_HEURISTIC> cost;     // 按变量
+    Vec<Variable, MEM_HEURISTIC> heap;
+    Vec<int, MEM_HEURISTIC> index;          // 变量在堆里的位置, -1表示不在
+
+    void init(int n)
+    {
+        cost.grow_to(n + 1, 0);
+        index.grow_to(n + 1, -1);
+    }
+
+    int empty() const { return heap.size() == 0; }
+
+    void update(Variable v, long long c)
+    {
+        cost[v] = c;
+        if (index[v] < 0) {
+            index[v] = heap.size();
+            heap.push(v);
+        }
+        up(index[v]);
+        down(index[v]);
+    }
+
+    Variable pop()
+    {
+        Variable top = heap[0];
+        heap[0] = heap.last();
+        index[heap[0]] = 0;
+        index[top] = -1;
+        heap.pop();
+        if (heap.size() > 1) down(0);
+        return top;
+    }
+
+    void up(int i)
+    {
+        Variable v = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) >> 1;
+            if (cost[heap[parent]] <= cost[v]) break;
+            heap[i] = heap[parent];
+            index[heap[i]] = i;
+            i = parent;
+        }
+        heap[i] = v;
+        index[v] = i;
+    }
+
+    void down(int i)
+    {
+        Variable v = heap[i];
+        int n = heap.size();
+        while (2 * i + 1 < n) {
+            int child = 2 * i + 1;
+            if (child + 1 < n && cost[heap[child + 1]] < cost[heap[child]]) child++;
+            if (cost[heap[child]] >= cost[v]) break;
+            heap[i] = heap[child];
+            index[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = v;
+        index[v] = i;
+    }
+};
+
+static long long elim_cost(const Simplifier* s, Variable v)
+{
+    return (long long)s->occurs[lit_index(v)].size() * s->occurs[lit_index(-v)].size();
+}
+
+// c(含v) 和 d(含-v) 的resolvent放进 out, 重言式返回FALSE
+static int resolve(Simplifier* s, int c, int d, Variable v, Vec<Literal>& out)
+{
+    out.clear();
+    const Literal* a = simp_lits(s, c);
+    const Literal* b = simp_lits(s, d);
+    int na = s->clauses[c].size, nb = s->clauses[d].size;
+    for (int k = 0; k < na; k++) {
+        if (lit_var(a[k]) == v) continue;
+        s->mark[lit_index(a[k])] = 1;
+        out.push(a[k]);
+    }
+    int tautology = FALSE;
+    for (int k = 0; k < nb && !tautology; k++) {
+        if (lit_var(b[k]) == v) continue;
+        if (s->mark[lit_index(-b[k])]) tautology = TRUE;
+        else if (!s->mark[lit_index(b[k])]) out.push(b[k]);
+    }
+    for (int k = 0; k < na; k++) s->mark[lit_index(a[k])] = 0;
+    return !tautology;
+}
+
+typedef struct {
+    Vec<Literal> resolvent;
+    Vec<int> pos;                   // 消元时含v/含-v子句的副本, 出现表会跟着变
+    Vec<int> neg;
+    Vec<Variable> touched;          // 消完以后出现次数变了的变量
+    Gate gate;
+    Vec<char> pos_gate;             // pos/neg 里的子句是不是门子句
+    Vec<char> neg_gate;
+    long long budget;
+} ElimScratch;
+
+static void touch_clause(Simplifier* s, int cref, Vec<Variable>& touched)
+{
+    const Literal* p = simp_lits(s, cref);
+    for (int k = 0; k < s->clauses[cref].size; k++) touched.push(lit_var(p[k]));
+}
+
+static void mark_gate_clauses(const Vec<int>& crefs, const Gate* g, Vec<char>& out)
+{
+    out.clear();
+    for (int i = 0; i < crefs.size(); i++) {
+        char in = 0;
+        for (int k = 0; k < g->clauses.size() && !in; k++) in = g->clauses[k] == crefs[i];
+        out.push(in);
+    }
+}
+
+static int try_eliminate(Simplifier* s, Variable v, const PreprocessOptions* options, ElimScratch* w)
+{
+    if (s->eliminated[v] || s->val[v] != UNASSIGNED) return FALSE;
+    const Vec<int>& pos = s->occurs[lit_index(v)];
+    const Vec<int>& neg = s->occurs[lit_index(-v)];
+    int np = pos.size(), nn = neg.size();
+    if (np + nn == 0 || np + nn > options->elim_occ_limit) return FALSE;
+
+    int gated = options->gates && simp_find_gate(s, v, &w->gate, &w->budget);
+    if (gated) {
+        mark_gate_clauses(pos, &w->gate, w->pos_gate);
+        mark_gate_clauses(neg, &w->gate, w->neg_gate);
+    }
+
+    // 先数一遍, resolvent比原来的子句多或者太长就不消
+    int count = 0;
+    for (int i = 0; i < np; i++) {
+        for (int j = 0; j < nn; j++) {
+            if (gated && w->pos_gate[i] == w->neg_gate[j]) continue;
+            w->budget -= s->clauses[pos[i]].size + s->clauses[neg[j]].size;
+            if (!resolve(s, pos[i], neg[j], v, w->resolvent)) continue;
+            if (w->resolvent.size() > options->elim_resolvent_limit || ++count > np + nn) return FALSE;
+        }
+    }
+
+    pos.copy_to(w->pos);
+    neg.copy_to(w->neg);
+    // 重建栈: 出现少的一边带着见证文字全存下来, 再存另一边的单元当默认值
+    Literal x = np <= nn ? v : -v;
+    const Vec<int>& kept = np <= nn ? w->pos : w->neg;
+    for (int i = 0; i < kept.size(); i++) simp_push_recon(s, kept[i], x);
+    s->recon->push(-x);
+    s->recon->push(1);
+
+    w->touched.clear();
+    for (int i = 0; i < w->pos.size(); i++) touch_clause(s, w->pos[i], w->touched);
+    for (int i = 0; i < w->neg.size(); i++) touch_clause(s, w->neg[i], w->touched);
+    for (int i = 0; i < w->pos.size() && s->ok; i++) {
+        for (int j = 0; j < w->neg.size() && s->ok; j++) {
+            if (gated && w->pos_gate[i] == w->neg_gate[j]) continue;
+            if (!resolve(s, w->pos[i], w->neg[j], v, w->resolvent)) continue;
+            simp_add_clause(s, w->resolvent.data(), w->resolvent.size());
+            s->stats->resolvents++;
+        }
+    }
+    for (int i = 0; i < w->pos.size(); i++) simp_remove_clause(s, w->pos[i]);
+    for (int i = 0; i < w->neg.size(); i++) simp_remove_clause(s, w->neg[i]);
+    s->eliminated[v] = 1;
+    s->stats->eliminated++;
+    if (gated) s->stats->gate_eliminated++;
+    simp_propagate(s);
+    return TRUE;
+}
+
+void simp_eliminate(Simplifier* s, const PreprocessOptions* options)
+{
+    ElimHeap heap;
+    heap.init(s->num_vars);
+    for (Variable v = 1; v <= s->num_vars; v++) {
+        if (s->eliminated[v] || s->val[v] != UNASSIGNED) continue;
+        if (s->occurs[lit_index(v)].size() + s->occurs[lit_index(-v)].size() == 0) continue;
+        heap.update(v, elim_cost(s, v));
+    }
+
+    ElimScratch w;
+    w.budget = options->elim_budget;
+    while (s->ok && !heap.empty() && w.budget > 0) {
+        Variable v = heap.pop();
+        if (!try_eliminate(s, v, options, &w)) continue;
+        for (int i = 0; i < w.touched.size(); i++) {
+            Variable t = w.touched[i];
+            if (t == v || s->eliminated[t] || s->val[t] != UNASSIGNED) continue;
+            heap.update(t, elim_cost(s, t));
+        }
+    }
+}
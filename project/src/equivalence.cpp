@@ -0,0 +1,93 @@
+#include "equivalence.h"
+
+// 非递归的Tarjan: 蕴含链可能很长, 递归会爆栈
+// 节点是 lit_index, 边按CSR存: 节点i的后继是 edges[start[i], start[i+1])
+static void tarjan(int n, const Vec<int>& start, const Vec<int>& edges, Vec<int>& comp)
+{
+    Vec<int> index, low, stack, call, pos;
+    Vec<char> on_stack;
+    index.grow_to(n, -1);
+    low.grow_to(n, 0);
+    on_stack.grow_to(n, 0);
+    comp.clear();
+    comp.grow_to(n, -1);
+    int counter = 0, components = 0;
+
+    for (int root = 0; root < n; root++) {
+        if (index[root] >= 0 || start[root] == start[root + 1]) continue;
+        index[root] = low[root] = counter++;
+        stack.push(root);
+        on_stack[root] = 1;
+        call.push(root);
+        pos.push(start[root]);
+        while (call.size() > 0) {
+            int v = call.last();
+            if (pos.last() < start[v + 1]) {
+                int w = edges[pos.last()++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = counter++;
+                    stack.push(w);
+                    on_stack[w] = 1;
+                    call.push(w);
+                    pos.push(start[w]);
+                } else if (on_stack[w] && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+            call.pop();
+            pos.pop();
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = stack.last();
+                    stack.pop();
+                    on_stack[w] = 0;
+                    comp[w] = components;
+                } while (w != v);
+                components++;
+            }
+            if (call.size() > 0 && low[v] < low[call.last()]) low[call.last()] = low[v];
+        }
+    }
+}
+
+int find_equivalences(int num_vars, const Vec<Literal>& binaries, Vec<Literal>& repr)
+{
+    int n = 2 * num_vars + 2;
+    Vec<int> start, edges, fill;
+    start.grow_to(n + 1, 0);
+    for (int i = 0; i < binaries.size(); i++) start[lit_index(-binaries[i]) + 1]++;
+    for (int i = 0; i < n; i++) start[i + 1] += start[i];
+    edges.grow_to(binaries.size(), 0);
+    fill.grow_to(n, 0);
+    for (int i = 0; i + 1 < binaries.size(); i += 2) {
+        Literal a = binaries[i], b = binaries[i + 1];
+        int from = lit_index(-a);
+        edges[start[from] + fill[from]++] = b;
+        from = lit_index(-b);
+        edges[start[from] + fill[from]++] = a;
+    }
+    for (int i = 0; i < edges.size(); i++) edges[i] = lit_index(edges[i]);
+
+    Vec<int> comp;
+    tarjan(n, start, edges, comp);
+
+    // 按变量从小到大看, 每个分量第一次碰到的文字就是代表
+    Vec<Literal> comp_repr;
+    comp_repr.grow_to(n, 0);
+    repr.clear();
+    repr.grow_to(num_vars + 1, 0);
+    for (Variable v = 0; v <= num_vars; v++) repr[v] = v;
+    for (Variable v = 1; v <= num_vars; v++) {
+        int cp = comp[lit_index(v)], cn = comp[lit_index(-v)];
+        if (cp < 0) continue;
+        if (cp == cn) return FALSE;
+        if (comp_repr[cp] == 0) {
+            comp_repr[cp] = v;
+            if (cn >= 0) comp_repr[cn] = -v;
+        }
+        repr[v] = comp_repr[cp];
+    }
+    return TRUE;
+}
@@ -1,9 +1,12 @@
 #include "fileop.h"
+#include "trace.h"
 #include <string.h>  // 显式包含，确保strrchr可用
+#include <ctype.h>
 // =========== 加载cnf文件 ===========
 
 int load_cnf_from_file(CNF* cnf, const char* filename)
 {
+    TRACE_SCOPE("load_cnf_from_file");
     FILE* file = fopen(filename, "r");
     if (!file) 
     {
@@ -47,36 +50,63 @@ int load_cnf_from_file(CNF* cnf, const char* filename)
         
         // 读取子句
         Clause clause;
-        init_literal_array(&clause.literals);
+        int ok = init_literal_array(&clause.literals);
         // char temp = line[0];
-        char *token = strtok(line, " \t\n");
+        char *token = ok ? strtok(line, " \t\n") : NULL;
         while (token)
         {
             int literal = atoi(token);  // string to int
             if (literal == 0) break; // 结束标志
-            push_literal(&clause.literals, literal);
+            if (!(ok = push_literal(&clause.literals, literal))) break;
             token = strtok(NULL, " \t\n"); // 接着之前的继续
         }
         
-        if (clause.literals.size > 0)
+        if (ok && clause.literals.size > 0)
         {
-            push_clause(&cnf->clauses, &clause);
+            ok = push_clause(&cnf->clauses, &clause);
         }
         free_literal_array(&clause.literals);
+        if (!ok)
+        {
+            // 内存不够就放弃这个文件, 而不是整个进程退出
+            fprintf(stderr, "Out of memory while reading %s (%d clauses read)\n", filename, cnf->clauses.size);
+            fclose(file);
+            return 0;
+        }
     }
     
     fclose(file);
     
-    // 调试信息（通过宏控制）
-    #ifdef DEBUG
-    printf("Successfully Read CNF File:\n");
-    printf("  Number of Variables: %d\n", cnf->num_variables);
-    printf("  Number of Clauses: %d (Actual Read: %d)\n", cnf->num_clauses, cnf->clauses.size);
-    #endif
+    // 调试信息（通过统计级别控制）
+    if (kStatsCounters) {
+        printf("Successfully Read CNF File:\n");
+        printf("  Number of Variables: %d\n", cnf->num_variables);
+        printf("  Number of Clauses: %d (Actual Read: %d)\n", cnf->num_clauses, cnf->clauses.size);
+    }
     
     return 1;
 }
 
+// 写成DIMACS, 一行一个子句(load_cnf_from_file 按行读)
+int save_cnf_to_file(const CNF* cnf, const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to create file: %s\n", filename);
+        return 0;
+    }
+    fprintf(file, "p cnf %d %d\n", cnf->num_variables, cnf->clauses.size);
+    for (int i = 0; i < cnf->clauses.size; i++) {
+        const LiteralArray* c = &cnf->clauses.data[i].literals;
+        for (int k = 0; k < c->size; k++) fprintf(file, "%d ", c->data[k]);
+        fprintf(file, "0\n");
+    }
+    int ok = !ferror(file);
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Failed to write file: %s\n", filename);
+    return ok;
+}
+
 // 交互式CNF文件加载，带用户输入
 int load_cnf_interactive(CNF* cnf, char* filename_out)
 {
@@ -188,8 +218,10 @@ void save_result(const char* filename, SatResult result, const Assignment* assig
             }
         }
         fprintf(file, "\n");
-    } else {
+    } else if (result == UNSAT) {
         fprintf(file, "s 0\n");
+    } else {
+        fprintf(file, "s -1\n"); // UNKNOWN: 预算用完或被取消
     }
     
     fprintf(file, "t %.0f\n", elapsed_time_ms);
@@ -197,7 +229,48 @@ void save_result(const char* filename, SatResult result, const Assignment* assig
     fclose(file);
 }
 
-void save_and_print_result(const char* input_file, SatResult result, const Assignment* assignment, double elapsed_time_ms)
+// 按词读: "v" 行可能很长, 不能按行读进固定的缓冲区
+int load_result(const char* filename, int num_variables, SatResult* result, Assignment* assignment)
+{
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open result file: %s\n", filename);
+        return 0;
+    }
+    if (!init_assignment(assignment, num_variables)) {
+        fclose(file);
+        return 0;
+    }
+    char token[32];
+    char section = 0;       // 当前在哪一行: 's', 'v', 't'
+    int status = -2;
+    int ok = 1;
+    while (ok && fscanf(file, "%31s", token) == 1) {
+        if (isalpha((unsigned char)token[0])) {
+            section = token[0];
+            continue;
+        }
+        int x = atoi(token);
+        if (section == 's') {
+            status = x;
+        } else if (section == 'v' && x != 0) {
+            Variable v = x > 0 ? x : -x;
+            if (v > num_variables) ok = 0;
+            else assignment->values[v] = x > 0 ? TRUE : FALSE;
+        }
+    }
+    fclose(file);
+    if (!ok || status < -1 || status > 1) {
+        fprintf(stderr, "Invalid result file: %s\n", filename);
+        free_assignment(assignment);
+        return 0;
+    }
+    *result = status == 1 ? SAT : (status == 0 ? UNSAT : UNKNOWN);
+    return 1;
+}
+
+// ask_verify为0时跳过验证的交互(命令行模式)
+static void save_and_print_result_impl(const char* input_file, SatResult result, const Assignment* assignment, double elapsed_time_ms, int ask_verify)
 {
     // 生成输出文件名
     char output_file[256];
@@ -252,7 +325,17 @@ void save_and_print_result(const char* input_file, SatResult result, const Assig
     }
     
     // 调用验证功能
-    verify_result(input_file, output_file);
+    if (ask_verify) verify_result(input_file, output_file);
+}
+
+void save_and_print_result(const char* input_file, SatResult result, const Assignment* assignment, double elapsed_time_ms)
+{
+    save_and_print_result_impl(input_file, result, assignment, elapsed_time_ms, 1);
+}
+
+void save_and_print_result_batch(const char* input_file, SatResult result, const Assignment* assignment, double elapsed_time_ms)
+{
+    save_and_print_result_impl(input_file, result, assignment, elapsed_time_ms, 0);
 }
 
 // 验证结果函数
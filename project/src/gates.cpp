@@ -0,0 +1,312 @@
+#include "simplifier.h"
+
+// =========== 门识别和结构哈希 ===========
+// 电路的 Tseitin 编码里, 每个门的输出变量由几个子句完整定义:
+//   AND  o = a1 & ... & ak : (-o | ai) 各一个, (o | -a1 | ... | -ak)
+//   XOR  o = a ^ b         : 同三个变量上奇偶性相同的四个三元子句
+//   ITE  o = c ? t : e     : (-o | -c | t) (-o | c | e) (o | -c | -t) (o | c | -e)
+// OR/NAND 等是输出取反的 AND, 两个极性都试就都能找到.
+//
+// 结构哈希: 类型和输入都相同的两个门输出相等. 删掉后一个门的定义子句, 加上两个输出
+// 等价的二元子句, 等价替换再把后一个输出换掉. 这一步前后的公式等价, 不用进重建栈.
+// 替换以后用到这两个输出的门也可能变成重复的, 所以重复到没有可合并的为止.
+//
+// 消元(elim.cpp)也用这里找定义: 门子句之间和非门子句之间的resolvent都不用加
+
+#define GATE_MAX_TERNARY 64     // 找 ITE 时输出一侧最多看这么多个三元子句
+#define GATE_HASH_ROUNDS 8      // 哈希加替换最多重复这么多轮
+
+static void mark_lits(Simplifier* s, const Literal* p, int n, char value)
+{
+    for (int k = 0; k < n; k++) s->mark[lit_index(p[k])] = value;
+}
+
+// 含 x, y, z 三个文字的三元子句, 没有返回-1
+static int find_ternary(Simplifier* s, Literal x, Literal y, Literal z, long long* budget)
+{
+    const Vec<int>* occ = &s->occurs[lit_index(x)];
+    if (s->occurs[lit_index(y)].size() < occ->size()) occ = &s->occurs[lit_index(y)];
+    if (s->occurs[lit_index(z)].size() < occ->size()) occ = &s->occurs[lit_index(z)];
+    for (int i = 0; i < occ->size(); i++) {
+        int c = (*occ)[i];
+        if (s->clauses[c].size != 3) continue;
+        *budget -= 3;
+        const Literal* p = simp_lits(s, c);
+        int found = 0;
+        for (int k = 0; k < 3; k++) found += p[k] == x || p[k] == y || p[k] == z;
+        if (found == 3) return c;
+    }
+    return -1;
+}
+
+// o = AND(inputs): 先把 (-o | a) 的a都标上, 再找所有其它文字取反都标过的长子句
+static int find_and(Simplifier* s, Literal o, Gate* g, long long* budget)
+{
+    const Vec<int>& bins = s->occurs[lit_index(-o)];
+    const Vec<int>& longs = s->occurs[lit_index(o)];
+    int marked = 0;
+    for (int i = 0; i < bins.size(); i++) {
+        if (s->clauses[bins[i]].size != 2) continue;
+        const Literal* p = simp_lits(s, bins[i]);
+        s->mark[lit_index(p[0] == -o ? p[1] : p[0])] = 1;
+        marked++;
+    }
+    int def = -1;
+    for (int i = 0; i < longs.size() && def < 0 && marked >= 2; i++) {
+        int c = longs[i];
+        int n = s->clauses[c].size;
+        if (n < 3 || n - 1 > marked) continue;
+        *budget -= n;
+        const Literal* p = simp_lits(s, c);
+        int all = TRUE;
+        for (int k = 0; k < n && all; k++) all = p[k] == o || s->mark[lit_index(-p[k])];
+        if (all) def = c;
+    }
+    for (int i = 0; i < bins.size(); i++) {
+        if (s->clauses[bins[i]].size != 2) continue;
+        const Literal* p = simp_lits(s, bins[i]);
+        s->mark[lit_index(p[0] == -o ? p[1] : p[0])] = 0;
+    }
+    *budget -= bins.size();
+    if (def < 0) return FALSE;
+
+    g->type = GATE_AND;
+    g->output = o;
+    g->inputs.clear();
+    g->clauses.clear();
+    g->clauses.push(def);
+    const Literal* p = simp_lits(s, def);
+    for (int k = 0; k < s->clauses[def].size; k++)
+        if (p[k] != o) {
+            g->inputs.push(-p[k]);
+            s->mark[lit_index(-p[k])] = 1;
+        }
+    // 每个输入留一个二元子句(有重复的二元子句时只取第一个)
+    for (int i = 0; i < bins.size(); i++) {
+        if (s->clauses[bins[i]].size != 2) continue;
+        const Literal* q = simp_lits(s, bins[i]);
+        Literal a = q[0] == -o ? q[1] : q[0];
+        if (!s->mark[lit_index(a)]) continue;
+        s->mark[lit_index(a)] = 0;
+        g->clauses.push(bins[i]);
+    }
+    return TRUE;
+}
+
+// v 所在的三元子句 (v | x | y) 加上另外三个同奇偶的子句
+static int find_xor(Simplifier* s, Variable v, Gate* g, long long* budget)
+{
+    const Vec<int>& occ = s->occurs[lit_index(v)];
+    for (int i = 0; i < occ.size() && *budget > 0; i++) {
+        int c = occ[i];
+        if (s->clauses[c].size != 3) continue;
+        const Literal* p = simp_lits(s, c);
+        Literal x = 0, y = 0;
+        for (int k = 0; k < 3; k++) {
+            if (p[k] == v) continue;
+            if (x == 0) x = p[k];
+            else y = p[k];
+        }
+        int c1 = find_ternary(s, v, -x, -y, budget);
+        int c2 = c1 < 0 ? -1 : find_ternary(s, -v, -x, y, budget);
+        int c3 = c2 < 0 ? -1 : find_ternary(s, -v, x, -y, budget);
+        if (c3 < 0) continue;
+        // 子句禁止的是文字全假的那个赋值, 四个子句禁掉同一奇偶性的四个赋值:
+        // v^a^b 等于 1 ^ (负文字个数的奇偶), 这里 v 是正的
+        int negative = (x < 0) + (y < 0);
+        g->type = GATE_XOR;
+        g->output = negative % 2 == 0 ? -v : v;
+        g->inputs.clear();
+        Variable a = lit_var(x), b = lit_var(y);
+        g->inputs.push(a < b ? a : b);
+        g->inputs.push(a < b ? b : a);
+        g->clauses.clear();
+        g->clauses.push(c);
+        g->clauses.push(c1);
+        g->clauses.push(c2);
+        g->clauses.push(c3);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+// 输出一侧的两个三元子句 (-o | -c | t) 和 (-o | c | e), 另一侧要有 (o | -c | -t) 和 (o | c | -e)
+static int find_ite(Simplifier* s, Literal o, Gate* g, long long* budget)
+{
+    const Vec<int>& occ = s->occurs[lit_index(-o)];
+    int ternaries = 0;
+    for (int i = 0; i < occ.size() && ternaries < GATE_MAX_TERNARY && *budget > 0; i++) {
+        int c1 = occ[i];
+        if (s->clauses[c1].size != 3) continue;
+        ternaries++;
+        const Literal* p = simp_lits(s, c1);
+        mark_lits(s, p, 3, 1);
+        for (int j = i + 1; j < occ.size(); j++) {
+            int c2 = occ[j];
+            if (s->clauses[c2].size != 3) continue;
+            *budget -= 3;
+            const Literal* q = simp_lits(s, c2);
+            Literal cond = 0, e = 0;
+            int clash = 0;
+            for (int k = 0; k < 3; k++) {
+                if (q[k] == -o) continue;
+                if (s->mark[lit_index(-q[k])]) {
+                    cond = q[k];
+                    clash++;
+                } else if (!s->mark[lit_index(q[k])]) {
+                    e = q[k];
+                }
+            }
+            if (clash != 1 || e == 0) continue;
+            Literal t = 0;
+            for (int k = 0; k < 3; k++)
+                if (p[k] != -o && p[k] != -cond) t = p[k];
+            if (t == 0 || lit_var(t) == lit_var(e)) continue;
+            int c3 = find_ternary(s, o, -cond, -t, budget);
+            int c4 = c3 < 0 ? -1 : find_ternary(s, o, cond, -e, budget);
+            if (c4 < 0) continue;
+            mark_lits(s, p, 3, 0);
+            // 规范形式: 条件和 then 分支都取正
+            Literal out = o;
+            if (cond < 0) {
+                cond = -cond;
+                Literal tmp = t;
+                t = e;
+                e = tmp;
+            }
+            if (t < 0) {
+                t = -t;
+                e = -e;
+                out = -out;
+            }
+            g->type = GATE_ITE;
+            g->output = out;
+            g->inputs.clear();
+            g->inputs.push(cond);
+            g->inputs.push(t);
+            g->inputs.push(e);
+            g->clauses.clear();
+            g->clauses.push(c1);
+            g->clauses.push(c2);
+            g->clauses.push(c3);
+            g->clauses.push(c4);
+            return TRUE;
+        }
+        mark_lits(s, p, 3, 0);
+    }
+    return FALSE;
+}
+
+int simp_find_gate(Simplifier* s, Variable v, Gate* g, long long* budget)
+{
+    if (find_and(s, v, g, budget) || find_and(s, -v, g, budget)) {
+        // 输入按文字排好, 哈希时才能比较
+        for (int i = 1; i < g->inputs.size(); i++)
+            for (int j = i; j > 0 && g->inputs[j - 1] > g->inputs[j]; j--) {
+                Literal tmp = g->inputs[j];
+                g->inputs[j] = g->inputs[j - 1];
+                g->inputs[j - 1] = tmp;
+            }
+        return TRUE;
+    }
+    return find_xor(s, v, g, budget) || find_ite(s, v, g, budget) || find_ite(s, -v, g, budget);
+}
+
+// =========== 结构哈希 ===========
+
+typedef struct {
+    unsigned long long hash;
+    Variable var;
+} GateRecord;
+
+static int compare_gate_records(const void* a, const void* b)
+{
+    const GateRecord* x = (const GateRecord*)a;
+    const GateRecord* y = (const GateRecord*)b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return x->var < y->var ? -1 : (x->var > y->var ? 1 : 0);
+}
+
+static unsigned long long gate_hash(const Gate* g)
+{
+    unsigned long long h = (unsigned long long)g->type * 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < g->inputs.size(); i++) h = (h ^ (unsigned int)g->inputs[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+static int same_function(const Gate* a, const Gate* b)
+{
+    if (a->type != b->type || a->inputs.size() != b->inputs.size()) return FALSE;
+    for (int i = 0; i < a->inputs.size(); i++)
+        if (a->inputs[i] != b->inputs[i]) return FALSE;
+    return TRUE;
+}
+
+static int uses_variable(const Gate* g, Variable v)
+{
+    for (int i = 0; i < g->inputs.size(); i++)
+        if (lit_var(g->inputs[i]) == v) return TRUE;
+    return FALSE;
+}
+
+// 一轮: 所有变量找定义, 按哈希排序, 同一哈希里和第一个函数相同的并过去. 返回合并数
+static int hash_round(Simplifier* s, long long* budget)
+{
+    Gate g, rep;
+    Vec<GateRecord> records;
+    for (Variable v = 1; v <= s->num_vars && *budget > 0; v++) {
+        if (s->val[v] != UNASSIGNED || s->eliminated[v]) continue;
+        if (!simp_find_gate(s, v, &g, budget)) continue;
+        if (g.type == GATE_AND) s->stats->gates_and++;
+        else if (g.type == GATE_XOR) s->stats->gates_xor++;
+        else s->stats->gates_ite++;
+        GateRecord r = { gate_hash(&g), v };
+        records.push(r);
+    }
+    qsort(records.data(), records.size(), sizeof(GateRecord), compare_gate_records);
+
+    int merged = 0;
+    Literal eq[2];
+    for (int i = 0; i < records.size();) {
+        int j = i + 1;
+        while (j < records.size() && records[j].hash == records[i].hash) j++;
+        // 前面的合并可能删掉了这里记下的定义子句, 合并前两边都重新找一遍
+        for (int k = i + 1; k < j && s->ok; k++) {
+            Variable a = records[i].var, b = records[k].var;
+            if (s->val[a] != UNASSIGNED || s->val[b] != UNASSIGNED) continue;
+            if (!simp_find_gate(s, a, &rep, budget) || !simp_find_gate(s, b, &g, budget)) continue;
+            if (!same_function(&rep, &g) || uses_variable(&rep, b) || uses_variable(&g, a)) continue;
+            for (int c = 0; c < g.clauses.size(); c++) simp_remove_clause(s, g.clauses[c]);
+            s->stats->gate_clauses_removed += g.clauses.size() - 2;
+            eq[0] = -rep.output;
+            eq[1] = g.output;
+            simp_add_clause(s, eq, 2);
+            eq[0] = rep.output;
+            eq[1] = -g.output;
+            simp_add_clause(s, eq, 2);
+            s->stats->gates_merged++;
+            merged++;
+        }
+        i = j;
+    }
+    return merged;
+}
+
+void simp_hash_gates(Simplifier* s, const PreprocessOptions* options)
+{
+    long long budget = options->gate_budget;
+    for (int round = 0; round < GATE_HASH_ROUNDS && s->ok && budget > 0; round++) {
+        // 门的个数只数第一轮的, 后面几轮是重新找同样的门
+        int and_gates = s->stats->gates_and, xor_gates = s->stats->gates_xor, ite_gates = s->stats->gates_ite;
+        int merged = hash_round(s, &budget);
+        if (round > 0) {
+            s->stats->gates_and = and_gates;
+            s->stats->gates_xor = xor_gates;
+            s->stats->gates_ite = ite_gates;
+        }
+        // 不做等价替换时等价二元子句留着, 不会再有新的重复门
+        if (merged == 0 || !options->substitute) break;
+        simp_substitute(s);
+        simp_propagate(s);
+    }
+}
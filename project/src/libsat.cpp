@@ -0,0 +1,85 @@
+#include "libsat.h"
+#include <new>
+
+// 句柄只是包了一层 SolverEngine, 这样头文件里不用暴露任何模板
+struct SatSolver {
+    SolverEngine* engine;
+};
+
+SatSolver* sat_solver_new(const SolverConfig* config)
+{
+    SolverConfig defaults;
+    if (!config) {
+        init_solver_config(&defaults);
+        config = &defaults;
+    }
+    SatSolver* solver = (SatSolver*)malloc(sizeof(SatSolver));
+    if (!solver) {
+        fprintf(stderr, "Memory Allocation Failed: sat_solver_new\n");
+        return NULL;
+    }
+    try {
+        solver->engine = create_solver_engine(config);
+    } catch (const std::bad_alloc&) {
+        fprintf(stderr, "Memory Allocation Failed: sat_solver_new\n");
+        free(solver);
+        return NULL;
+    }
+    return solver;
+}
+
+void sat_solver_delete(SatSolver* solver)
+{
+    if (!solver) return;
+    delete solver->engine;
+    free(solver);
+}
+
+int sat_add_clause(SatSolver* solver, const Literal* lits, int size)
+{
+    return solver->engine->add_clause(lits, size);
+}
+
+int sat_add_cnf(SatSolver* solver, const CNF* cnf)
+{
+    for (int i = 0; i < cnf->clauses.size; i++) {
+        const Clause* clause = &cnf->clauses.data[i];
+        if (!solver->engine->add_clause(clause->literals.data, clause->literals.size)) return FALSE;
+    }
+    return TRUE;
+}
+
+SatResult sat_solve(SatSolver* solver)
+{
+    return solver->engine->solve();
+}
+
+int sat_model_value(const SatSolver* solver, Variable var)
+{
+    return solver->engine->model_value(var);
+}
+
+int sat_num_variables(const SatSolver* solver)
+{
+    return solver->engine->num_variables();
+}
+
+const SolverStats* sat_stats(const SatSolver* solver)
+{
+    return &solver->engine->stats();
+}
+
+SatResult sat_solve_assuming(SatSolver* solver, const Literal* assumptions, int count)
+{
+    return solver->engine->solve(assumptions, count);
+}
+
+const Literal* sat_failed_assumptions(const SatSolver* solver, int* count)
+{
+    return solver->engine->failed_assumptions(count);
+}
+
+void sat_interrupt(SatSolver* solver)
+{
+    solver->engine->interrupt();
+}
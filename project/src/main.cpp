@@ -4,79 +4,613 @@
 #include "sat_solver.h"
 #include "fileop.h"
 #include "sudoku.h"
+#include "perf_profile.h"
+#include "trace.h"
+#include "portfolio.h"
+#include "cube.h"
+#include "parallel_dpll.h"
+#include "distributed.h"
+#include "preprocess.h"
+
+// 并行模式的命令行选项
+typedef struct {
+    int portfolio;          // portfolio线程数, -1 表示不用portfolio
+    long long deterministic;    // 确定性portfolio每轮的传播数, -1 表示自由模式
+    int cube;               // 是否用cube-and-conquer
+    CubeOptions cube_options;
+    int dpll;               // 并行DPLL的线程数, -1 表示不用
+    int distribute;         // 工作进程数, -1 表示不用多进程
+    const char* worker_command;
+} ParallelOptions;
+
+static void print_usage(const char* prog)
+{
+    printf("Usage: %s [options] [file.cnf]\n", prog);
+    printf("Without a CNF file the interactive menu is shown.\n");
+    printf("Options:\n");
+    printf("  --profile    Report hardware counters (Linux perf_event) for parse and search\n");
+    printf("  --trace FILE Write a Chrome/Perfetto trace-event JSON (needs SAT_ENABLE_TRACE build)\n");
+    printf("  --heuristic vsids|jw              Decision heuristic (default vsids)\n");
+    printf("  --propagation watched|counting    Propagation engine (default watched)\n");
+    printf("  --restart luby|geometric|none     Restart policy (default luby)\n");
+    printf("  --phase false|true|random         Initial phase before phase saving (default false)\n");
+    printf("  --seed N     Random seed for the initial variable order (default 0: none)\n");
+    printf("  --portfolio N   Run N diversified solvers in parallel, first answer wins (0: one per core)\n");
+    printf("  --deterministic K  Portfolio threads sync every K propagations (0: %d); same seed, same result\n",
+           PORTFOLIO_SYNC_DEFAULT);
+    printf("  --share-lbd N   Portfolio threads exchange learned clauses with LBD <= N (default 2, 0: off)\n");
+    printf("  --share-rate N  Export at most N literals per conflict on average (default 4)\n");
+    printf("  --cube-depth N  Cube-and-conquer: split by lookahead up to N levels (default 8 with --cube-limit)\n");
+    printf("  --cube-limit N  Cube-and-conquer: at most N cubes (default 256)\n");
+    printf("  --threads N     Cube-and-conquer worker threads (default 0: one per core)\n");
+    printf("  --dpll N        Plain DPLL tree search (no learning) on N work-stealing threads (0: one per core)\n");
+    printf("  --distribute N  Run N worker processes over pipes (cubes with --cube-*, else portfolio; 0: one per core)\n");
+    printf("  --worker-cmd C  Start workers with /bin/sh -c C instead of this program (e.g. \"ssh host sat_solver --worker\")\n");
+    printf("  --no-preprocess Search the formula exactly as loaded\n");
+    printf("  --no-elim       No bounded variable elimination, neither in preprocessing nor during search\n");
+    printf("  --no-subsume    No subsumption, neither in preprocessing nor on learned clauses during search\n");
+    printf("  --no-probe      No failed-literal probing, neither in preprocessing nor during search\n");
+    printf("  --no-vivify     Do not vivify learned clauses during search\n");
+    printf("  --no-inprocess  No simplification during search (preprocessing still runs)\n");
+    printf("  --inprocess-interval N  Conflicts between simplification rounds during search (default 10000)\n");
+    printf("  --no-gates      Preprocess without gate recognition (AND/XOR/ITE merging, definition-based elimination)\n");
+    printf("  --bva           Also run bounded variable addition (auxiliary variables for clause patterns)\n");
+    printf("  --no-bce        Preprocess without blocked clause elimination\n");
+    printf("  --cce           Also remove covered clauses (blocked after covered literal addition)\n");
+    printf("  --bce-budget N  Literals visited by blocked/covered clause elimination (default 100000000)\n");
+    printf("  --no-substitute No equivalent-literal substitution, neither in preprocessing nor during search\n");
+    printf("  --probe-budget N  Clauses visited while probing (default 20000000)\n");
+    printf("  --simplify OUT  Only preprocess: write the simplified CNF to OUT and its reconstruction file\n");
+    printf("  --recon FILE    Reconstruction file for --simplify (default OUT with extension .rec) or --extend\n");
+    printf("  --extend RES    Extend a result for the simplified CNF to file.cnf using --recon, verify, save it\n");
+    printf("  --mem-limit MB  Solver memory cap; learned clauses are dropped first, then Unknown\n");
+    printf("  --time-limit S          Wall-clock budget in seconds, then Unknown\n");
+    printf("  --conflict-limit N      Conflict budget\n");
+    printf("  --decision-limit N      Decision budget\n");
+    printf("  --propagation-limit N   Propagation budget\n");
+    printf("Ctrl-C / SIGTERM stop the search and report Unknown with partial statistics;\n");
+    printf("a second signal terminates immediately.\n");
+    printf("  --help       Show this message\n");
+}
+
+// CNF求解模式, cnf_path为NULL时交互式选择文件
+static void print_portfolio_result(PortfolioResult* pres)
+{
+    char winner_name[96];
+    describe_solver_config(&pres->winner_config, winner_name, sizeof(winner_name));
+    if (pres->winner >= 0) printf("Portfolio: %d threads, winner #%d (%s)\n", pres->threads, pres->winner, winner_name);
+    else printf("Portfolio: %d threads, no winner\n", pres->threads);
+    // 自由模式和确定性模式比吞吐: 每个线程每秒的传播数, 确定性模式在屏障上等的时间也算在内
+    if (pres->rounds > 0) printf("Portfolio: deterministic, %lld rounds\n", pres->rounds);
+    printf("Portfolio: %.0f propagations/s per thread\n",
+           pres->thread_seconds > 0 ? pres->total_propagations / pres->thread_seconds : 0.0);
+    printf("Portfolio: shared clause store %.1f KB, exchange buffer %.1f KB, conflicts over all threads %lld\n",
+           pres->store_bytes / 1024.0, pres->exchange_bytes / 1024.0, pres->total_conflicts);
+    if (kStatsCounters && pres->exchange_bytes > 0 && pres->thread_stats) {
+        for (int i = 0; i < pres->threads; i++) {
+            const SolverStats* t = &pres->thread_stats[i];
+            printf("  #%-2d Conflicts: %lld, Exported: %lld, Imported: %lld, Dropped: %lld, Missed: %lld\n", i,
+                   t->conflicts, t->shared_exported, t->shared_imported, t->shared_dropped, t->shared_missed);
+        }
+    }
+    free_portfolio_result(pres);
+}
+
+static void print_cube_result(const CubeResult* cres)
+{
+    printf("Cubes: %d (refuted by lookahead: %d, solved: %d, stolen: %d), %d threads\n",
+           cres->cubes, cres->refuted, cres->solved, cres->steals, cres->threads);
+    printf("Cubes: lookahead %.0f ms, conquer %.0f ms, load balance %.0f%%\n",
+           cres->lookahead_seconds * 1000, cres->conquer_seconds * 1000, cres->efficiency * 100);
+    if (cres->solved > 0)
+        printf("Cube Time: min %.1f ms, median %.1f ms, mean %.1f ms, max %.1f ms\n", cres->cube_min * 1000,
+               cres->cube_median * 1000, cres->cube_mean * 1000, cres->cube_max * 1000);
+}
+
+static void print_dpll_result(const DpllResult* dres)
+{
+    printf("DPLL: %d threads, %d subtrees (%d stolen), search busy %.0f%%\n", dres->threads, dres->tasks,
+           dres->tasks > 0 ? dres->tasks - 1 : 0, dres->efficiency * 100);
+}
+
+static void print_distributed_result(const DistributedResult* dist)
+{
+    printf("Workers: %d processes, %d work items (refuted by lookahead: %d, completed: %d), %d lost\n",
+           dist->workers, dist->work_items, dist->refuted, dist->completed, dist->lost);
+    printf("Workers: %lld clauses forwarded, %.1f KB sent, %.1f KB received\n", dist->clauses_forwarded,
+           dist->bytes_sent / 1024.0, dist->bytes_received / 1024.0);
+}
+
+static void print_preprocess_stats(const PreprocessStats* ps)
+{
+    printf("Preprocess: variables %d -> %d, clauses %d -> %d, literals %lld -> %lld (%.0f ms)\n",
+           ps->vars_before, ps->vars_after, ps->clauses_before, ps->clauses_after, ps->lits_before,
+           ps->lits_after, ps->seconds * 1000);
+    printf("Preprocess: %d fixed, %d eliminated, %d substituted, %lld resolvents added\n", ps->fixed,
+           ps->eliminated, ps->substituted, ps->resolvents);
+    printf("Preprocess: %d clauses subsumed, %lld literals strengthened away\n", ps->subsumed, ps->strengthened);
+    printf("Preprocess: %d blocked clauses, %d covered clauses removed\n", ps->blocked, ps->covered);
+    if (ps->gates_and + ps->gates_xor + ps->gates_ite > 0) {
+        printf("Preprocess: gates %d AND, %d XOR, %d ITE; %d duplicates merged, %d clauses removed\n", ps->gates_and,
+               ps->gates_xor, ps->gates_ite, ps->gates_merged, ps->gate_clauses_removed);
+        printf("Preprocess: %d variables eliminated by gate definition\n", ps->gate_eliminated);
+    }
+    if (ps->bva_variables > 0)
+        printf("Preprocess: %d auxiliary variables added, %d clauses saved by variable addition\n",
+               ps->bva_variables, ps->bva_clauses);
+    printf("Preprocess: %d probed, %d failed literals, %d common implications, %d equivalences\n", ps->probed,
+           ps->failed_literals, ps->probe_units, ps->probe_equivalences);
+}
+
+// preprocess 为NULL时不做预处理
+static int run_cnf_mode(const char* cnf_path, const SolverConfig* config, const ParallelOptions* parallel,
+                        const PreprocessOptions* preprocess)
+{
+    // Initialize CNF
+    CNF cnf;
+    init_cnf(&cnf);
+
+    char input_file[256];
+    perf_phase_begin(PERF_PHASE_PARSE);
+    int loaded;
+    if (cnf_path) {
+        // 命令行给了文件就直接读
+        snprintf(input_file, sizeof(input_file), "%s", cnf_path);
+        printf("Loading CNF file: %s\n", input_file);
+        loaded = load_cnf_from_file(&cnf, input_file);
+    } else {
+        // Interactive load CNF file
+        loaded = load_cnf_interactive(&cnf, input_file);
+    }
+    perf_phase_end(PERF_PHASE_PARSE);
+    if (!loaded) {
+        free_cnf(&cnf);
+        return 1;
+    }
+
+    // Initialize assignment
+    Assignment assignment;
+    if (!init_assignment(&assignment, cnf.num_variables)) {
+        free_cnf(&cnf);
+        return 1;
+    }
+
+    char config_name[64];
+    describe_solver_config(config, config_name, sizeof(config_name));
+    printf("\nStart Solving... (%s)\n", config_name);
+    // 墙钟时间: 并行模式下 clock() 会把所有线程的CPU时间加在一起
+    double start_time = solver_wall_seconds();
+
+    // 预处理: 拿化简后的公式去求解, SAT时用重建栈把模型补全
+    const CNF* formula = &cnf;
+    CNF simplified;
+    Reconstruction recon;
+    init_reconstruction(&recon);
+    PreprocessStats pstats;
+    if (preprocess && preprocess_cnf(&cnf, &simplified, &recon, preprocess, &pstats)) {
+        formula = &simplified;
+        print_preprocess_stats(&pstats);
+    }
+    // BVA 加的辅助变量也要在赋值里占位, 输出时只写原来的变量
+    if (formula->num_variables > assignment.size) {
+        free_assignment(&assignment);
+        if (!init_assignment(&assignment, formula->num_variables)) {
+            if (formula != &cnf) free_cnf(&simplified);
+            free_cnf(&cnf);
+            return 1;
+        }
+    }
+
+    // Solve
+    perf_phase_begin(PERF_PHASE_SEARCH);
+    SatResult result;
+    SolverStats stats;
+    PortfolioResult pres;
+    CubeResult cres;
+    DpllResult dres;
+    DistributedResult dist;
+    {
+        TRACE_SCOPE("search");
+        if (parallel->distribute >= 0) {
+            DistributedOptions options;
+            init_distributed_options(&options);
+            options.workers = parallel->distribute;
+            options.cube = parallel->cube;
+            options.cube_options = parallel->cube_options;
+            options.worker_command = parallel->worker_command;
+            result = distributed_solve(formula, &assignment, config, &options, &dist);
+            stats = dist.stats;
+            stats.memory = *mem_current_tracker();
+        } else if (parallel->dpll >= 0) {
+            result = parallel_dpll_solve(formula, &assignment, config, parallel->dpll, &dres);
+            memset(&stats, 0, sizeof(stats));
+            stats.decisions = dres.decisions;
+            stats.conflicts = dres.conflicts;
+            stats.propagations = dres.propagations;
+            stats.stop_reason = dres.stop_reason;
+            stats.memory = *mem_current_tracker();
+        } else if (parallel->cube) {
+            result = cube_and_conquer(formula, &assignment, config, &parallel->cube_options, &cres);
+            stats = cres.stats;
+        } else if (parallel->portfolio >= 0) {
+            if (parallel->deterministic >= 0)
+                result = portfolio_solve_deterministic(formula, &assignment, config, parallel->portfolio,
+                                                       parallel->deterministic, &pres);
+            else
+                result = portfolio_solve(formula, &assignment, config, parallel->portfolio, &pres);
+            stats = pres.winner_stats;
+        } else {
+            result = solve_cnf(formula, &assignment, config, &stats);
+        }
+    }
+    perf_phase_end(PERF_PHASE_SEARCH);
+    if (formula != &cnf) {
+        if (result == SAT) extend_model(&recon, &assignment);
+        free_cnf(&simplified);
+    }
+
+    double elapsed_time_ms = (solver_wall_seconds() - start_time) * 1000;
+
+    // Output result
+    printf("Solving Completed!\n");
+    printf("Result: %s\n", (result == SAT) ? "Satisfiable (SAT)" :
+                      (result == UNSAT) ? "Unsatisfiable (UNSAT)" :
+                      "Unknown");
+    if (result == UNKNOWN) printf("Stopped By: %s\n", stop_reason_name(stats.stop_reason));
+    if (parallel->distribute >= 0) print_distributed_result(&dist);
+    else if (parallel->dpll >= 0) print_dpll_result(&dres);
+    else if (parallel->cube) print_cube_result(&cres);
+    else if (parallel->portfolio >= 0) print_portfolio_result(&pres);
+    printf("Solving Time: %.0f ms\n", elapsed_time_ms);
+
+    if (kStatsCounters) {
+        print_solver_stats(&stats);
+        print_memory_report(&stats.memory);
+        printf("        input CNF: %.1f KB\n", mem_current_tracker()->peak_total / 1024.0);
+    }
+    perf_profile_report(stats.propagations);
+
+    // Save file and do final output and verification
+    // 命令行模式不弹验证的交互
+    Assignment original = assignment;
+    original.size = cnf.num_variables;
+    if (cnf_path) save_and_print_result_batch(input_file, result, &original, elapsed_time_ms);
+    else save_and_print_result(input_file, result, &original, elapsed_time_ms);
+
+    // Cleanup memory
+    free_assignment(&assignment);
+    free_cnf(&cnf);
+    return 0;
+}
+
+// 化简后的CNF旁边默认放同名的 .rec 重建文件
+static void default_recon_path(const char* cnf_out, char* path, size_t size)
+{
+    snprintf(path, size, "%s", cnf_out);
+    char* dot = strrchr(path, '.');
+    char* slash = strrchr(path, '/');
+    if (dot && (!slash || dot > slash)) *dot = '\0';
+    size_t len = strlen(path);
+    snprintf(path + len, size - len, ".rec");
+}
+
+// 只做预处理: 写出化简后的CNF和重建文件, 不求解
+static int run_simplify_mode(const char* cnf_path, const char* out_path, const char* recon_path,
+                             const PreprocessOptions* preprocess)
+{
+    CNF cnf;
+    init_cnf(&cnf);
+    printf("Loading CNF file: %s\n", cnf_path);
+    if (!load_cnf_from_file(&cnf, cnf_path)) {
+        free_cnf(&cnf);
+        return 1;
+    }
+    CNF simplified;
+    Reconstruction recon;
+    init_reconstruction(&recon);
+    PreprocessStats pstats;
+    if (!preprocess_cnf(&cnf, &simplified, &recon, preprocess, &pstats)) {
+        free_cnf(&cnf);
+        return 1;
+    }
+    print_preprocess_stats(&pstats);
+
+    char default_path[512];
+    if (!recon_path) {
+        default_recon_path(out_path, default_path, sizeof(default_path));
+        recon_path = default_path;
+    }
+    int ok = save_cnf_to_file(&simplified, out_path) && save_reconstruction(recon_path, &recon, cnf.num_variables, simplified.num_variables);
+    if (ok) {
+        printf("Simplified CNF saved to: %s\n", out_path);
+        printf("Reconstruction (%d literals) saved to: %s\n", recon.stack.size(), recon_path);
+    }
+    free_cnf(&simplified);
+    free_cnf(&cnf);
+    return ok ? 0 : 1;
+}
+
+// 赋值下每个子句都有真文字, 否则打印第一个假子句
+static int check_model(const CNF* cnf, const Assignment* assignment)
+{
+    for (int i = 0; i < cnf->clauses.size; i++) {
+        const LiteralArray* c = &cnf->clauses.data[i].literals;
+        int satisfied = FALSE;
+        for (int k = 0; k < c->size && !satisfied; k++) {
+            Literal l = c->data[k];
+            Variable v = l > 0 ? l : -l;
+            satisfied = v <= assignment->size && assignment->values[v] == (l > 0 ? TRUE : FALSE);
+        }
+        if (!satisfied) {
+            printf("Clause %d is not satisfied\n", i + 1);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// 把化简后公式的结果补成原公式的模型, 验证后照常写 res/<原文件名>.res
+static int run_extend_mode(const char* cnf_path, const char* res_path, const char* recon_path)
+{
+    if (!recon_path) {
+        fprintf(stderr, "--extend needs --recon FILE\n");
+        return 1;
+    }
+    CNF cnf;
+    init_cnf(&cnf);
+    printf("Loading CNF file: %s\n", cnf_path);
+    if (!load_cnf_from_file(&cnf, cnf_path)) {
+        free_cnf(&cnf);
+        return 1;
+    }
+    Reconstruction recon;
+    init_reconstruction(&recon);
+    int num_variables, formula_variables;
+    if (!load_reconstruction(recon_path, &recon, &num_variables, &formula_variables)) {
+        free_cnf(&cnf);
+        return 1;
+    }
+    if (num_variables != cnf.num_variables) {
+        fprintf(stderr, "Reconstruction file is for %d variables, CNF has %d\n", num_variables, cnf.num_variables);
+        free_cnf(&cnf);
+        return 1;
+    }
+    SatResult result;
+    Assignment assignment;
+    if (!load_result(res_path, formula_variables, &result, &assignment)) {
+        free_cnf(&cnf);
+        return 1;
+    }
+
+    int ret = 0;
+    if (result == SAT) {
+        extend_model(&recon, &assignment);
+        // 化简后的公式里不出现的变量, 求解器可能没写, 随便取假
+        for (int v = 1; v <= assignment.size; v++)
+            if (assignment.values[v] == UNASSIGNED) assignment.values[v] = FALSE;
+        if (check_model(&cnf, &assignment)) {
+            printf("Extended model verified: all %d clauses satisfied\n", cnf.clauses.size);
+        } else {
+            printf("Extended model does NOT satisfy the original formula\n");
+            ret = 1;
+        }
+    }
+    printf("Result: %s\n", (result == SAT) ? "Satisfiable (SAT)" :
+                          (result == UNSAT) ? "Unsatisfiable (UNSAT)" :
+                          "Unknown");
+    Assignment original = assignment;
+    original.size = cnf.num_variables;
+    if (ret == 0) save_and_print_result_batch(cnf_path, result, &original, 0);
+    free_assignment(&assignment);
+    free_cnf(&cnf);
+    return ret;
+}
 
 int main(int argc, char* argv[]) {
+    // 工作进程: 标准输入输出是协议通道, 什么都不能先打印
+    if (argc == 2 && strcmp(argv[1], "--worker") == 0) return run_stdio_worker();
+
+    const char* cnf_path = NULL;
+    const char* trace_path = NULL;
+    int profile = 0;
+    ParallelOptions parallel;
+    parallel.portfolio = -1;
+    parallel.deterministic = -1;
+    parallel.cube = FALSE;
+    parallel.dpll = -1;
+    parallel.distribute = -1;
+    parallel.worker_command = NULL;
+    init_cube_options(&parallel.cube_options);
+    SolverConfig config;
+    init_solver_config(&config);
+    PreprocessOptions preprocess;
+    init_preprocess_options(&preprocess);
+    int use_preprocess = TRUE;
+    const char* simplify_path = NULL;   // 只做预处理时的输出CNF
+    const char* extend_path = NULL;     // 要补全的结果文件
+    const char* recon_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0) {
+            profile = 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--heuristic") == 0 && i + 1 < argc) {
+            if (!parse_heuristic(argv[++i], &config.heuristic)) {
+                fprintf(stderr, "Unknown heuristic: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--propagation") == 0 && i + 1 < argc) {
+            if (!parse_propagation(argv[++i], &config.propagation)) {
+                fprintf(stderr, "Unknown propagation engine: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--restart") == 0 && i + 1 < argc) {
+            if (!parse_restart(argv[++i], &config.restart)) {
+                fprintf(stderr, "Unknown restart policy: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--phase") == 0 && i + 1 < argc) {
+            if (!parse_phase(argv[++i], &config.phase)) {
+                fprintf(stderr, "Unknown phase: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--portfolio") == 0 && i + 1 < argc) {
+            parallel.portfolio = atoi(argv[++i]);
+            if (parallel.portfolio < 0) parallel.portfolio = 0;
+        } else if (strcmp(argv[i], "--deterministic") == 0 && i + 1 < argc) {
+            parallel.deterministic = atoll(argv[++i]);
+            if (parallel.deterministic < 0) parallel.deterministic = 0;
+            if (parallel.portfolio < 0) parallel.portfolio = 0;
+        } else if (strcmp(argv[i], "--cube-depth") == 0 && i + 1 < argc) {
+            parallel.cube = TRUE;
+            parallel.cube_options.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cube-limit") == 0 && i + 1 < argc) {
+            parallel.cube = TRUE;
+            parallel.cube_options.limit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dpll") == 0 && i + 1 < argc) {
+            parallel.dpll = atoi(argv[++i]);
+            if (parallel.dpll < 0) parallel.dpll = 0;
+        } else if (strcmp(argv[i], "--distribute") == 0 && i + 1 < argc) {
+            parallel.distribute = atoi(argv[++i]);
+            if (parallel.distribute < 0) parallel.distribute = 0;
+        } else if (strcmp(argv[i], "--worker-cmd") == 0 && i + 1 < argc) {
+            parallel.worker_command = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            parallel.cube_options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--share-lbd") == 0 && i + 1 < argc) {
+            config.share_lbd = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--share-rate") == 0 && i + 1 < argc) {
+            config.share_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--no-preprocess") == 0) {
+            use_preprocess = FALSE;
+        } else if (strcmp(argv[i], "--no-elim") == 0) {
+            preprocess.elim = FALSE;
+            config.inprocess_mask &= ~(1 << INPROCESS_ELIM);
+        } else if (strcmp(argv[i], "--no-substitute") == 0) {
+            preprocess.substitute = FALSE;
+            config.inprocess_mask &= ~(1 << INPROCESS_SUBSTITUTE);
+        } else if (strcmp(argv[i], "--no-gates") == 0) {
+            preprocess.gates = FALSE;
+        } else if (strcmp(argv[i], "--bva") == 0) {
+            preprocess.bva = TRUE;
+        } else if (strcmp(argv[i], "--no-bce") == 0) {
+            preprocess.bce = FALSE;
+        } else if (strcmp(argv[i], "--cce") == 0) {
+            preprocess.cce = TRUE;
+        } else if (strcmp(argv[i], "--bce-budget") == 0 && i + 1 < argc) {
+            preprocess.bce_budget = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--no-probe") == 0) {
+            preprocess.probe = FALSE;
+            config.inprocess_mask &= ~(1 << INPROCESS_PROBE);
+        } else if (strcmp(argv[i], "--probe-budget") == 0 && i + 1 < argc) {
+            preprocess.probe_budget = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--no-subsume") == 0) {
+            preprocess.subsume = FALSE;
+            config.inprocess_mask &= ~(1 << INPROCESS_SUBSUME);
+        } else if (strcmp(argv[i], "--no-vivify") == 0) {
+            config.inprocess_mask &= ~(1 << INPROCESS_VIVIFY);
+        } else if (strcmp(argv[i], "--no-inprocess") == 0) {
+            config.inprocess_interval = 0;
+        } else if (strcmp(argv[i], "--inprocess-interval") == 0 && i + 1 < argc) {
+            config.inprocess_interval = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--simplify") == 0 && i + 1 < argc) {
+            simplify_path = argv[++i];
+        } else if (strcmp(argv[i], "--recon") == 0 && i + 1 < argc) {
+            recon_path = argv[++i];
+        } else if (strcmp(argv[i], "--extend") == 0 && i + 1 < argc) {
+            extend_path = argv[++i];
+        } else if (strcmp(argv[i], "--mem-limit") == 0 && i + 1 < argc) {
+            double mb = atof(argv[++i]);
+            if (mb <= 0) {
+                fprintf(stderr, "Invalid memory limit: %s\n", argv[i]);
+                return 1;
+            }
+            config.mem_limit = (long long)(mb * 1024 * 1024);
+        } else if (strcmp(argv[i], "--time-limit") == 0 && i + 1 < argc) {
+            config.time_limit = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--conflict-limit") == 0 && i + 1 < argc) {
+            config.conflict_limit = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--decision-limit") == 0 && i + 1 < argc) {
+            config.decision_limit = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--propagation-limit") == 0 && i + 1 < argc) {
+            config.propagation_limit = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            cnf_path = argv[i];
+        }
+    }
+
+    // 统计打开时每2秒输出一次求解状态
+    if (kStatsCounters) {
+        config.progress = print_solver_progress;
+        config.progress_interval = 2.0;
+    }
+
     printf("=== SAT SOLVER ===\n");
+    if (profile) perf_profile_enable();
+    if (trace_path) trace_open(trace_path);
+
+    int ret = 0;
+    if ((simplify_path || extend_path) && !cnf_path) {
+        fprintf(stderr, "--simplify and --extend need a CNF file\n");
+        return 1;
+    }
+    if (simplify_path) {
+        ret = run_simplify_mode(cnf_path, simplify_path, recon_path, &preprocess);
+        trace_close();
+        return ret;
+    }
+    if (extend_path) {
+        ret = run_extend_mode(cnf_path, extend_path, recon_path);
+        trace_close();
+        return ret;
+    }
+    if (cnf_path) {
+        install_cancel_handlers();
+        ret = run_cnf_mode(cnf_path, &config, &parallel, use_preprocess ? &preprocess : NULL);
+        perf_profile_disable();
+        trace_close();
+        return ret;
+    }
+
     printf("Please select mode:\n");
     printf("1. Generate and solve Sudoku puzzle\n");
     printf("2. Load CNF file and solve\n");
     printf("Enter your choice (1/2): ");
-    
+
     int mode_choice;
     scanf("%d", &mode_choice);
     while (getchar() != '\n');  // 清除输入缓冲区
-    
+
     if (mode_choice == 1) {
         // 数独生成和求解模式
         int result = generate_and_solve_sudoku();
         printf("\nSudoku generation and solving %s\n", result ? "completed successfully" : "failed");
     } else if (mode_choice == 2) {
         // 原有的CNF求解功能
-        // Initialize CNF
-        CNF cnf;
-        init_cnf(&cnf);
-        
-        // Interactive load CNF file
-        char input_file[256];
-        if (!load_cnf_interactive(&cnf, input_file)) {
-            free_cnf(&cnf);
-            return 1;
+        install_cancel_handlers();
+        ret = run_cnf_mode(NULL, &config, &parallel, use_preprocess ? &preprocess : NULL);
+        if (ret != 0) {
+            perf_profile_disable();
+            trace_close();
+            return ret;
         }
-        
-        // Initialize assignment
-        Assignment assignment;
-        init_assignment(&assignment, cnf.num_variables);
-        
-        // Reset solving state counters
-        extern int dpll_call_count, unit_propagation_count, backtrack_count;
-        extern time_t last_output_time;
-        dpll_call_count = 0;
-        unit_propagation_count = 0;
-        backtrack_count = 0;
-        last_output_time = time(NULL);
-        
-        printf("\nStart Solving...\n");
-        clock_t start_time = clock();
-        
-        // Solve
-        SatResult result = dpll_solve(&cnf, &assignment);
-        
-        clock_t end_time = clock();
-        double elapsed_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
-        double elapsed_time_ms = elapsed_time * 1000;
-        
-        // Output result
-        printf("Solving Completed!\n");
-        printf("Result: %s\n", (result == SAT) ? "Satisfiable (SAT)" : 
-                          (result == UNSAT) ? "Unsatisfiable (UNSAT)" : "Unknown");
-        printf("Solving Time: %.0f ms\n", elapsed_time_ms);
-        
-    #ifdef DEBUG
-        printf("Statistics: DPLL Calls: %d, Unit Propagations: %d, Backtracks: %d\n", 
-               dpll_call_count, unit_propagation_count, backtrack_count);
-    #endif
-
-        // Save file and do final output and verification
-        save_and_print_result(input_file, result, &assignment, elapsed_time_ms);
-        
-        // Cleanup memory
-        free_assignment(&assignment);
-        free_cnf(&cnf);
     } else {
         printf("Invalid choice. Exiting.\n");
+        trace_close();
         return 1;
     }
 
+    perf_profile_disable();
+    trace_close();
     printf("Program Ended\n");
     return 0;
 }
@@ -0,0 +1,110 @@
+#include "mem_track.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+static const char* const subsystem_names[MEM_SUBSYSTEM_COUNT] = {
+    "clauses", "watches", "heuristic", "trail", "other"
+};
+
+// 每个线程一份默认记账, 多个求解器各自记自己的, 互不干扰
+static thread_local MemTracker default_tracker;
+static thread_local MemTracker* current_tracker = NULL;
+
+void init_mem_tracker(MemTracker* tracker, long long limit)
+{
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->limit = limit;
+}
+
+int mem_over_limit(const MemTracker* tracker)
+{
+    return tracker->limit > 0 && tracker->total > tracker->limit;
+}
+
+MemTracker* mem_current_tracker(void)
+{
+    return current_tracker ? current_tracker : &default_tracker;
+}
+
+MemTracker* mem_swap_tracker(MemTracker* tracker)
+{
+    MemTracker* prev = mem_current_tracker();
+    current_tracker = tracker;
+    return prev;
+}
+
+// 记一笔, delta可以为负
+static void account(MemTracker* t, long long delta, MemSubsystem sub, int is_alloc)
+{
+    t->bytes[sub] += delta;
+    t->total += delta;
+    if (is_alloc) t->allocs[sub]++;
+    if (t->bytes[sub] > t->peak_bytes[sub]) t->peak_bytes[sub] = t->bytes[sub];
+    if (t->total > t->peak_total) t->peak_total = t->total;
+}
+
+void* mem_alloc(MemTracker* tracker, size_t bytes, MemSubsystem sub)
+{
+    void* p = malloc(bytes);
+    if (!p) return NULL;
+    account(tracker ? tracker : mem_current_tracker(), (long long)bytes, sub, 1);
+    return p;
+}
+
+void* mem_realloc(MemTracker* tracker, void* p, size_t old_bytes, size_t new_bytes, MemSubsystem sub)
+{
+    // 失败时原来的块还在, 账也不变
+    void* q = realloc(p, new_bytes);
+    if (!q) return NULL;
+    account(tracker ? tracker : mem_current_tracker(), (long long)new_bytes - (long long)old_bytes, sub, 1);
+    return q;
+}
+
+void mem_free(MemTracker* tracker, void* p, size_t bytes, MemSubsystem sub)
+{
+    if (!p) return;
+    free(p);
+    account(tracker ? tracker : mem_current_tracker(), -(long long)bytes, sub, 0);
+}
+
+void mem_fail(const char* where)
+{
+    fprintf(stderr, "Memory Allocation Failed: %s\n", where);
+    MemoryExhausted e = { where };
+    throw e;
+}
+
+long mem_peak_rss_kb(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // macOS单位是字节
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+void print_memory_report(const MemTracker* tracker)
+{
+    printf("Memory: %-10s %12s %12s %10s\n", "subsystem", "current(KB)", "peak(KB)", "allocs");
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        printf("        %-10s %12.1f %12.1f %10lld\n", subsystem_names[i],
+               tracker->bytes[i] / 1024.0, tracker->peak_bytes[i] / 1024.0, tracker->allocs[i]);
+    }
+    printf("        %-10s %12.1f %12.1f", "total", tracker->total / 1024.0, tracker->peak_total / 1024.0);
+    if (tracker->limit > 0) printf("   (limit %.2f MB)", tracker->limit / (1024.0 * 1024.0));
+    printf("\n");
+    long rss = mem_peak_rss_kb();
+    if (rss >= 0) printf("        peak RSS: %.1f MB\n", rss / 1024.0);
+    else printf("        peak RSS: n/a\n");
+}
@@ -0,0 +1,112 @@
+#include "occ_propagator.h"
+#include "search_state.h"
+
+typedef struct {
+    Variable var;
+    int count;
+} VarCount;
+
+static int compare_var_count(const void* a, const void* b)
+{
+    const VarCount* x = (const VarCount*)a;
+    const VarCount* y = (const VarCount*)b;
+    if (x->count != y->count) return x->count > y->count ? -1 : 1;
+    return x->var - y->var;
+}
+
+int init_occ_propagator(OccPropagator* prop, const ClauseStore* store)
+{
+    prop->store = store;
+    prop->root = 0;
+    prop->propagations = 0;
+    int n = store->num_vars;
+    prop->occurs.grow_to(2 * n + 2);
+    prop->watches.grow_to(2 * n + 2);
+    prop->watch.grow_to(2 * store->num_clauses(), 0);
+    prop->val.grow_to(n + 1, (signed char)UNASSIGNED);
+    for (int i = 0; i < store->num_clauses(); i++) {
+        const Literal* c = store->clause(i);
+        int size = store->clause_size(i);
+        for (int k = 0; k < size; k++) prop->occurs[lit_index(c[k])].push(i);
+        if (size < 2) continue;
+        prop->watch[2 * i] = c[0];
+        prop->watch[2 * i + 1] = c[1];
+        prop->watches[lit_index(c[0])].push(i);
+        prop->watches[lit_index(c[1])].push(i);
+    }
+
+    Vec<VarCount> counts;
+    for (Variable v = 1; v <= n; v++) {
+        VarCount vc = { v, prop->occurs[lit_index(v)].size() + prop->occurs[lit_index(-v)].size() };
+        if (vc.count > 0) counts.push(vc);
+    }
+    qsort(counts.data(), counts.size(), sizeof(VarCount), compare_var_count);
+    for (int i = 0; i < counts.size(); i++) prop->order.push(counts[i].var);
+
+    if (store->has_empty) return FALSE;
+    for (int i = 0; i < store->num_clauses(); i++)
+        if (store->clause_size(i) == 1 && !occ_assign(prop, store->clause(i)[0])) return FALSE;
+    prop->root = prop->trail.size();
+    return TRUE;
+}
+
+int occ_assign(OccPropagator* prop, Literal lit)
+{
+    int v0 = occ_value(prop, lit);
+    if (v0 != UNASSIGNED) return v0 == TRUE;
+    int head = prop->trail.size();
+    prop->val[lit_var(lit)] = (signed char)(lit > 0 ? TRUE : FALSE);
+    prop->trail.push(lit);
+
+    const ClauseStore* store = prop->store;
+    while (head < prop->trail.size()) {
+        Literal p = prop->trail[head++];
+        prop->propagations++;
+        Literal false_lit = -p;
+        Vec<int>& ws = prop->watches[lit_index(false_lit)];
+        int j = 0;
+        for (int k = 0; k < ws.size(); k++) {
+            int ci = ws[k];
+            Literal* w = &prop->watch[2 * ci];
+            if (w[0] == false_lit) {
+                w[0] = w[1];
+                w[1] = false_lit;
+            }
+            if (occ_value(prop, w[0]) == TRUE) {
+                ws[j++] = ci;
+                continue;
+            }
+            // 找一个不为假的文字换掉 false_lit
+            const Literal* c = store->clause(ci);
+            int n = store->clause_size(ci);
+            int moved = FALSE;
+            for (int i = 0; i < n; i++) {
+                Literal l = c[i];
+                if (l == w[0] || l == w[1] || occ_value(prop, l) == FALSE) continue;
+                w[1] = l;
+                prop->watches[lit_index(l)].push(ci);
+                moved = TRUE;
+                break;
+            }
+            if (moved) continue;
+            ws[j++] = ci;
+            if (occ_value(prop, w[0]) == FALSE) {
+                for (k++; k < ws.size(); k++) ws[j++] = ws[k];
+                ws.shrink(j);
+                return FALSE;
+            }
+            prop->val[lit_var(w[0])] = (signed char)(w[0] > 0 ? TRUE : FALSE);
+            prop->trail.push(w[0]);
+        }
+        ws.shrink(j);
+    }
+    return TRUE;
+}
+
+void occ_backtrack(OccPropagator* prop, int size)
+{
+    while (prop->trail.size() > size) {
+        prop->val[lit_var(prop->trail.last())] = UNASSIGNED;
+        prop->trail.pop();
+    }
+}
@@ -0,0 +1,362 @@
+#include "parallel_dpll.h"
+#include "occ_propagator.h"
+#include "search_state.h"
+#include "trace.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// 决策栈的一层
+typedef struct {
+    Literal lit;        // 这一层当前分支的决策文字
+    int trail_size;     // 决策之前trail的长度
+    char bit;           // 0: 第一个分支, 1: 第二个分支
+    char open;          // 第二个分支还没试, 也没被偷走
+} DpllFrame;
+
+struct DpllWorker {
+    MemTracker mem;                 // 每个线程自己记账, 必须在Vec之前声明
+    std::mutex mutex;               // 保护 frames 和 base_*, 别的线程来偷时要拿
+    Vec<DpllFrame> frames;
+    Vec<Literal> base_lits;         // 当前子树的前缀决策
+    Vec<char> base_bits;            // 前缀在整棵树里的路径
+    Vec<char> best;                 // 最左解路径的本地副本
+    int best_version;
+    OccPropagator prop;
+    long long decisions;
+    long long conflicts;
+    long long counted_decisions;    // 已经加到共享计数里的部分
+    long long counted_conflicts;
+    long long counted_propagations;
+    double busy;
+    int tasks;
+};
+
+struct DpllShared {
+    const ClauseStore* store;
+    int threads;
+    DpllWorker* workers;
+    double deadline;                // 0 表示不限时
+    long long conflict_limit;       // 各线程加起来算, 0 表示不限
+    long long decision_limit;
+    long long propagation_limit;
+    int counted;                    // 有计数预算时每个决策和冲突都要检查
+    std::atomic<long long> decisions;
+    std::atomic<long long> conflicts;
+    std::atomic<long long> propagations;
+
+    std::mutex mutex;               // 保护 best_path 和模型
+    Vec<char> best_path;            // 目前最左的解的路径
+    std::atomic<int> best_version;  // 0 表示还没有解
+    Assignment* assignment;
+
+    std::atomic<int> active;        // 手上有子树的线程数
+    std::atomic<int> stop;
+    StopReason stop_reason;
+};
+
+// 路径按字典序比, 第一个分支在前; 一个是另一个的前缀(祖先)时算相等
+static int compare_path(const char* a, int na, const char* b, int nb)
+{
+    int n = na < nb ? na : nb;
+    for (int i = 0; i < n; i++)
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+// 当前节点是不是已经在最左解的右边了(右边的解不会被采用)
+// frames 只有自己会扩容, 别的线程只改 open, 所以这里读 bit 不用加锁
+static int right_of_best(DpllShared* sh, DpllWorker* w)
+{
+    int version = sh->best_version.load(std::memory_order_acquire);
+    if (version == 0) return FALSE;
+    if (version != w->best_version) {
+        std::lock_guard<std::mutex> lock(sh->mutex);
+        sh->best_path.copy_to(w->best);
+        w->best_version = sh->best_version.load(std::memory_order_relaxed);
+    }
+    // 先比前缀, 再比栈上的各层
+    int nb = w->base_bits.size();
+    int c = compare_path(w->base_bits.data(), nb, w->best.data(), w->best.size());
+    if (c != 0 || nb >= w->best.size()) return c > 0;
+    for (int i = 0; i < w->frames.size() && nb + i < w->best.size(); i++)
+        if (w->frames[i].bit != w->best[nb + i]) return w->frames[i].bit > w->best[nb + i];
+    return FALSE;
+}
+
+static void record_model(DpllShared* sh, DpllWorker* w)
+{
+    std::lock_guard<std::mutex> lock(sh->mutex);
+    Vec<char>& path = w->best;      // 借用本地副本拼路径
+    path.clear();
+    for (int i = 0; i < w->base_bits.size(); i++) path.push(w->base_bits[i]);
+    for (int i = 0; i < w->frames.size(); i++) path.push(w->frames[i].bit);
+    if (sh->best_version.load() != 0 &&
+        compare_path(path.data(), path.size(), sh->best_path.data(), sh->best_path.size()) >= 0)
+        return;
+    // best_path 在主线程里预先留够了容量, 这里不会扩容(线程的记账在线程结束后就没了)
+    sh->best_path.clear();
+    for (int i = 0; i < path.size(); i++) sh->best_path.push(path[i]);
+    Assignment* a = sh->assignment;
+    for (Variable v = 1; v <= a->size; v++)
+        a->values[v] = v < w->prop.val.size() && w->prop.val[v] == TRUE ? TRUE : FALSE;
+    int version = sh->best_version.load() + 1;
+    sh->best_version.store(version, std::memory_order_release);
+    w->best_version = 0;
+}
+
+// 把这个线程新增的计数加到共享计数里, 返回加完的总数
+static long long add_count(std::atomic<long long>* total, long long count, long long* counted)
+{
+    long long delta = count - *counted;
+    *counted = count;
+    return total->fetch_add(delta, std::memory_order_relaxed) + delta;
+}
+
+// 检查冲突/决策/传播预算, 时间和Ctrl-C, 该停了返回TRUE; 时钟只在 check_clock 时读
+static int should_stop(DpllShared* sh, DpllWorker* w, int check_clock)
+{
+    if (sh->stop.load(std::memory_order_relaxed)) return TRUE;
+    long long conflicts = add_count(&sh->conflicts, w->conflicts, &w->counted_conflicts);
+    long long decisions = add_count(&sh->decisions, w->decisions, &w->counted_decisions);
+    long long propagations = add_count(&sh->propagations, w->prop.propagations, &w->counted_propagations);
+    StopReason why = STOP_NONE;
+    if (sh->conflict_limit > 0 && conflicts >= sh->conflict_limit) why = STOP_CONFLICTS;
+    else if (sh->decision_limit > 0 && decisions >= sh->decision_limit) why = STOP_DECISIONS;
+    else if (sh->propagation_limit > 0 && propagations >= sh->propagation_limit) why = STOP_PROPAGATIONS;
+    else if (cancel_requested()) why = STOP_CANCELLED;
+    else if (check_clock && sh->deadline > 0 && solver_wall_seconds() >= sh->deadline) why = STOP_TIME;
+    if (why == STOP_NONE) return FALSE;
+    std::lock_guard<std::mutex> lock(sh->mutex);
+    if (!sh->stop.load()) sh->stop_reason = why;
+    sh->stop.store(1);
+    return TRUE;
+}
+
+// 出现多的相位先试
+static Literal pick_branch(DpllWorker* w)
+{
+    OccPropagator* prop = &w->prop;
+    for (int i = 0; i < prop->order.size(); i++) {
+        Variable v = prop->order[i];
+        if (prop->val[v] != UNASSIGNED) continue;
+        return prop->occurs[lit_index(v)].size() >= prop->occurs[lit_index(-v)].size() ? v : -v;
+    }
+    return 0;
+}
+
+static void clear_frames(DpllWorker* w)
+{
+    std::lock_guard<std::mutex> lock(w->mutex);
+    w->frames.clear();
+}
+
+// 搜索前缀 base_lits 下面的整棵子树
+static void run_task(DpllShared* sh, DpllWorker* w)
+{
+    TRACE_SCOPE("subtree");
+    double t0 = solver_wall_seconds();
+    w->tasks++;
+    OccPropagator* prop = &w->prop;
+    occ_backtrack(prop, prop->root);
+    clear_frames(w);
+
+    int ok = TRUE;
+    for (int i = 0; i < w->base_lits.size() && ok; i++) ok = occ_assign(prop, w->base_lits[i]);
+    if (!ok) w->conflicts++;
+
+    unsigned int tick = 0;
+    while (ok) {
+        int clock = (++tick & 255) == 0;
+        if ((clock || sh->counted) && should_stop(sh, w, clock)) break;
+        Literal lit = pick_branch(w);
+        if (lit == 0) {
+            record_model(sh, w);
+            break;      // 栈上剩下的分支都在这个解的右边
+        }
+        {
+            std::lock_guard<std::mutex> lock(w->mutex);
+            DpllFrame f = { lit, prop->trail.size(), 0, 1 };
+            w->frames.push(f);
+        }
+        w->decisions++;
+        ok = occ_assign(prop, lit);
+
+        // 冲突: 回到最近一个还有第二个分支的层
+        while (!ok) {
+            w->conflicts++;
+            if (sh->counted && should_stop(sh, w, FALSE)) break;
+            Literal flip = 0;
+            int trail_size = 0;
+            {
+                std::lock_guard<std::mutex> lock(w->mutex);
+                while (w->frames.size() > 0 && !w->frames.last().open) w->frames.pop();
+                if (w->frames.size() > 0) {
+                    DpllFrame& f = w->frames.last();
+                    f.open = 0;
+                    f.bit = 1;
+                    f.lit = -f.lit;
+                    flip = f.lit;
+                    trail_size = f.trail_size;
+                }
+            }
+            if (flip == 0 || right_of_best(sh, w)) break;
+            occ_backtrack(prop, trail_size);
+            ok = occ_assign(prop, flip);
+        }
+        if (ok && right_of_best(sh, w)) break;
+    }
+    clear_frames(w);
+    w->busy += solver_wall_seconds() - t0;
+}
+
+// 从别的线程栈上偷最浅的还没试的分支, 偷到了返回TRUE(active已经加上)
+static int steal(DpllShared* sh, int self)
+{
+    DpllWorker* w = &sh->workers[self];
+    for (int k = 1; k < sh->threads; k++) {
+        DpllWorker* victim = &sh->workers[(self + k) % sh->threads];
+        std::lock_guard<std::mutex> vlock(victim->mutex);
+        int i = 0;
+        while (i < victim->frames.size() && !victim->frames[i].open) i++;
+        if (i == victim->frames.size()) continue;
+
+        std::lock_guard<std::mutex> lock(w->mutex);
+        victim->base_lits.copy_to(w->base_lits);
+        victim->base_bits.copy_to(w->base_bits);
+        for (int j = 0; j < i; j++) {
+            w->base_lits.push(victim->frames[j].lit);
+            w->base_bits.push(victim->frames[j].bit);
+        }
+        w->base_lits.push(-victim->frames[i].lit);
+        w->base_bits.push(1);
+        victim->frames[i].open = 0;
+        sh->active.fetch_add(1);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static void dpll_worker(DpllShared* sh, int index)
+{
+    TRACE_THREAD_NAME("dpll", index);
+    DpllWorker* w = &sh->workers[index];
+    MemScope scope(&w->mem);
+    try {
+        init_occ_propagator(&w->prop, sh->store);
+        if (index == 0) {
+            run_task(sh, w);
+            sh->active.fetch_sub(1);
+        }
+        while (!sh->stop.load()) {
+            // 偷不到就让出CPU, 直到偷到, 停下, 或者谁手上都没有子树了
+            int stolen;
+            {
+                TRACE_SCOPE("steal");
+                while (!(stolen = steal(sh, index)) && !sh->stop.load() && sh->active.load() != 0)
+                    std::this_thread::yield();
+            }
+            if (!stolen) break;
+            run_task(sh, w);
+            sh->active.fetch_sub(1);
+        }
+    } catch (const MemoryExhausted&) {
+        std::lock_guard<std::mutex> lock(sh->mutex);
+        if (!sh->stop.load()) sh->stop_reason = STOP_MEMORY;
+        sh->stop.store(1);
+    }
+}
+
+SatResult parallel_dpll_solve(const CNF* cnf, Assignment* assignment, const SolverConfig* config, int threads,
+                              DpllResult* result)
+{
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    DpllResult local;
+    if (!result) result = &local;
+    memset(result, 0, sizeof(*result));
+    result->threads = threads;
+    double t0 = solver_wall_seconds();
+
+    ClauseStore store;
+    if (!build_clause_store(&store, cnf)) {
+        result->stop_reason = STOP_MEMORY;
+        return UNKNOWN;
+    }
+    MemScope scope(&store.mem);
+
+    DpllShared sh;
+    sh.store = &store;
+    sh.threads = threads;
+    sh.deadline = config->time_limit > 0 ? t0 + config->time_limit : 0;
+    sh.conflict_limit = config->conflict_limit;
+    sh.decision_limit = config->decision_limit;
+    sh.propagation_limit = config->propagation_limit;
+    sh.counted = sh.conflict_limit > 0 || sh.decision_limit > 0 || sh.propagation_limit > 0;
+    sh.decisions.store(0);
+    sh.conflicts.store(0);
+    sh.propagations.store(0);
+    sh.best_version.store(0);
+    sh.assignment = assignment;
+    sh.active.store(1);     // 0号线程从整棵树开始
+    sh.stop.store(0);
+    sh.stop_reason = STOP_NONE;
+    sh.workers = new (std::nothrow) DpllWorker[threads];
+    std::thread* workers = new (std::nothrow) std::thread[threads];
+    SatResult answer = UNKNOWN;
+    int ok = sh.workers && workers;
+    try {
+        // 第0层就矛盾的话不用开线程
+        OccPropagator probe;
+        if (ok && !init_occ_propagator(&probe, &store)) {
+            answer = UNSAT;
+            ok = FALSE;
+        }
+        // 解的路径最长是变量数, 预先分配好, 工作线程里不会再让它扩容
+        if (ok) sh.best_path.reserve(store.num_vars + 1);
+    } catch (const MemoryExhausted&) {
+        ok = FALSE;
+        result->stop_reason = STOP_MEMORY;
+    }
+
+    if (ok) {
+        for (int i = 0; i < threads; i++) {
+            DpllWorker* w = &sh.workers[i];
+            init_mem_tracker(&w->mem, 0);
+            w->best_version = 0;
+            w->decisions = 0;
+            w->conflicts = 0;
+            w->counted_decisions = 0;
+            w->counted_conflicts = 0;
+            w->counted_propagations = 0;
+            w->busy = 0;
+            w->tasks = 0;
+        }
+        for (int i = 0; i < threads; i++) workers[i] = std::thread(dpll_worker, &sh, i);
+        for (int i = 0; i < threads; i++) workers[i].join();
+
+        double busy = 0;
+        for (int i = 0; i < threads; i++) {
+            DpllWorker* w = &sh.workers[i];
+            result->decisions += w->decisions;
+            result->conflicts += w->conflicts;
+            result->propagations += w->prop.propagations;
+            result->tasks += w->tasks;
+            busy += w->busy;
+        }
+        // 停下之前已经找到的解照样是模型, 只是不一定是最左的那个
+        if (sh.best_version.load() != 0) answer = SAT;
+        else if (sh.stop.load()) result->stop_reason = sh.stop_reason;
+        else answer = UNSAT;
+        result->seconds = solver_wall_seconds() - t0;
+        if (result->seconds > 0) result->efficiency = busy / (threads * result->seconds);
+    } else if (answer == UNKNOWN && result->stop_reason == STOP_NONE) {
+        fprintf(stderr, "Memory Allocation Failed: parallel_dpll_solve\n");
+        result->stop_reason = STOP_MEMORY;
+    }
+
+    delete[] workers;
+    delete[] sh.workers;
+    return answer;
+}
@@ -0,0 +1,191 @@
+#include "perf_profile.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// =========== 计数器状态 ===========
+
+static const char* const phase_names[PERF_PHASE_COUNT] = { "parse", "search" };
+
+static int profile_on = 0;                              // --profile 打开后为1
+static int fds[PERF_PHASE_COUNT][PERF_EV_COUNT];        // -1 表示不可用
+static int open_errno = 0;                              // 第一次打开失败的原因
+
+#ifdef __linux__
+static int open_counter(PerfEvent ev)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;          // 由 perf_phase_begin 打开
+    attr.exclude_kernel = 1;    // 只看用户态, paranoid=2 时也能用
+    attr.exclude_hv = 1;
+    attr.inherit = 1;           // 之后开的线程也算进来(portfolio, cube, dpll, 作业池)
+    // 计数器不够时内核会分时复用, 读的时候按运行时间比例放大
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (ev) {
+        case PERF_EV_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_EV_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_EV_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PERF_EV_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PERF_EV_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            return -1;
+    }
+
+    // pid=0, cpu=-1: 统计当前线程和它之后创建的线程, 不限CPU
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0 && open_errno == 0) open_errno = errno;
+    return fd;
+}
+
+// 读出按复用比例修正后的计数值, 不可用返回-1
+static long long read_counter(int fd)
+{
+    if (fd < 0) return -1;
+    unsigned long long buf[3]; // value, time_enabled, time_running
+    if (read(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) return -1;
+    if (buf[2] == 0) return buf[1] == 0 ? 0 : -1; // 从没跑过
+    if (buf[2] < buf[1]) return (long long)((double)buf[0] * buf[1] / buf[2]);
+    return (long long)buf[0];
+}
+#endif
+
+// =========== 对外接口 ===========
+
+int perf_profile_enable(void)
+{
+    int usable = 0;
+    for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+        for (int e = 0; e < PERF_EV_COUNT; e++) {
+#ifdef __linux__
+            fds[p][e] = open_counter((PerfEvent)e);
+#else
+            fds[p][e] = -1;
+#endif
+            if (fds[p][e] >= 0) usable++;
+        }
+    }
+    profile_on = 1;
+
+    if (usable == 0) {
+#ifdef __linux__
+        fprintf(stderr, "Profiling: hardware counters unavailable (%s), "
+                        "check /proc/sys/kernel/perf_event_paranoid\n", strerror(open_errno));
+#else
+        fprintf(stderr, "Profiling: hardware counters are only supported on Linux\n");
+#endif
+    }
+    return usable;
+}
+
+int perf_profile_enabled(void)
+{
+    return profile_on;
+}
+
+void perf_phase_begin(PerfPhase phase)
+{
+    if (!profile_on) return;
+#ifdef __linux__
+    for (int e = 0; e < PERF_EV_COUNT; e++)
+        if (fds[phase][e] >= 0) ioctl(fds[phase][e], PERF_EVENT_IOC_ENABLE, 0);
+#else
+    (void)phase;
+#endif
+}
+
+void perf_phase_end(PerfPhase phase)
+{
+    if (!profile_on) return;
+#ifdef __linux__
+    for (int e = 0; e < PERF_EV_COUNT; e++)
+        if (fds[phase][e] >= 0) ioctl(fds[phase][e], PERF_EVENT_IOC_DISABLE, 0);
+#else
+    (void)phase;
+#endif
+}
+
+// 按列打印, 不可用的计数器打印 n/a
+static void print_count(long long v)
+{
+    if (v < 0) printf(" %14s", "n/a");
+    else printf(" %14lld", v);
+}
+
+static void print_ratio(long long num, long long den)
+{
+    if (num < 0 || den <= 0) printf(" %10s", "n/a");
+    else printf(" %10.3f", (double)num / (double)den);
+}
+
+void perf_profile_report(long long propagations)
+{
+    if (!profile_on) return;
+
+    printf("Hardware Counters (user space):\n");
+    printf("  %-8s %14s %14s %14s %14s %14s %10s\n",
+           "Phase", "Cycles", "Instructions", "L1D-Misses", "LLC-Misses", "Branch-Misses", "IPC");
+    for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+        long long v[PERF_EV_COUNT];
+        for (int e = 0; e < PERF_EV_COUNT; e++) {
+#ifdef __linux__
+            v[e] = read_counter(fds[p][e]);
+#else
+            v[e] = -1;
+#endif
+        }
+        printf("  %-8s", phase_names[p]);
+        for (int e = 0; e < PERF_EV_COUNT; e++) print_count(v[e]);
+        print_ratio(v[PERF_EV_INSTRUCTIONS], v[PERF_EV_CYCLES]);
+        printf("\n");
+
+        // 每次单元传播的开销, 只对搜索阶段有意义
+        if (p == PERF_PHASE_SEARCH && propagations > 0) {
+            printf("  per propagation (%lld):", propagations);
+            printf(" cycles"); print_ratio(v[PERF_EV_CYCLES], propagations);
+            printf(" L1D"); print_ratio(v[PERF_EV_L1D_MISSES], propagations);
+            printf(" LLC"); print_ratio(v[PERF_EV_LLC_MISSES], propagations);
+            printf(" branch"); print_ratio(v[PERF_EV_BRANCH_MISSES], propagations);
+            printf("\n");
+        }
+    }
+}
+
+void perf_profile_disable(void)
+{
+    if (!profile_on) return;
+#ifdef __linux__
+    for (int p = 0; p < PERF_PHASE_COUNT; p++)
+        for (int e = 0; e < PERF_EV_COUNT; e++)
+            if (fds[p][e] >= 0) close(fds[p][e]);
+#endif
+    profile_on = 0;
+}
@@ -0,0 +1,323 @@
+#include "portfolio.h"
+#include "clause_store.h"
+#include "clause_exchange.h"
+#include "trace.h"
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// 1号线程开始依次取, 超过表长就绕回来, 只靠种子区分
+typedef struct {
+    HeuristicKind heuristic;
+    RestartKind restart;
+    PhaseKind phase;
+} Diversity;
+
+static const Diversity diversity_table[] = {
+    { HEURISTIC_VSIDS, RESTART_GEOMETRIC, PHASE_TRUE },
+    { HEURISTIC_VSIDS, RESTART_LUBY,      PHASE_RANDOM },
+    { HEURISTIC_JW,    RESTART_LUBY,      PHASE_FALSE },
+    { HEURISTIC_VSIDS, RESTART_GEOMETRIC, PHASE_FALSE },
+    { HEURISTIC_VSIDS, RESTART_NONE,      PHASE_RANDOM },
+    { HEURISTIC_JW,    RESTART_GEOMETRIC, PHASE_TRUE },
+    { HEURISTIC_VSIDS, RESTART_LUBY,      PHASE_TRUE },
+};
+static const int diversity_count = sizeof(diversity_table) / sizeof(diversity_table[0]);
+
+void portfolio_config(const SolverConfig* base, int index, SolverConfig* out)
+{
+    *out = *base;
+    if (index == 0) return;
+    const Diversity* d = &diversity_table[(index - 1) % diversity_count];
+    out->heuristic = d->heuristic;
+    out->restart = d->restart;
+    out->phase = d->phase;
+    out->seed = base->seed + (unsigned int)index;
+    // 进度只让0号线程报, 不然输出会乱
+    out->progress = NULL;
+}
+
+// 线程之间共享的状态, 都由mutex保护
+typedef struct {
+    std::mutex mutex;
+    const ClauseStore* store;
+    ClauseExchange* exchange;   // NULL 表示不交换学习子句
+    SolverEngine** engines;     // 正在跑的求解器, 用来打断
+    SolverConfig* configs;
+    SolverStats* stats;         // 每个线程结束时的统计
+    int threads;
+    int winner;
+    SatResult result;
+    Assignment* assignment;
+    double thread_seconds;
+
+    // 确定性模式
+    const SolverConfig* base;
+    long long sync;             // 每轮的传播数, 0 表示自由模式
+    std::condition_variable round_cv;
+    int arrived;                // 这一轮已经到屏障的线程数
+    long long rounds;           // 结束了的轮数, 等着的线程看它变没变
+    int done;
+    SatResult* round_result;    // 每个线程这一轮的结果
+    int* finished;              // 预算或内存用完的线程不再求解, 但还要到屏障
+    StopReason reason;          // 都没有结果时的停止原因
+    double deadline;
+} PortfolioShared;
+
+static void portfolio_worker(PortfolioShared* shared, int index)
+{
+    TRACE_THREAD_NAME("portfolio", index);
+    double t0 = solver_wall_seconds();
+    SolverEngine* engine;
+    try {
+        engine = create_solver_engine(&shared->configs[index]);
+    } catch (const std::bad_alloc&) {
+        return;
+    }
+    if (shared->exchange) engine->connect_exchange(shared->exchange, index);
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->engines[index] = engine;
+        if (shared->winner >= 0) engine->interrupt();
+    }
+
+    const ClauseStore* store = shared->store;
+    for (int i = 0; i < store->num_clauses(); i++)
+        if (!engine->add_shared_clause(store->clause(i), store->clause_size(i))) break;
+    SatResult result = engine->solve();
+
+    {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->thread_seconds += solver_wall_seconds() - t0;
+        shared->engines[index] = NULL;
+        shared->stats[index] = engine->stats();
+        if (result != UNKNOWN && shared->winner < 0) {
+            shared->winner = index;
+            shared->result = result;
+            if (result == SAT) {
+                Assignment* a = shared->assignment;
+                for (int v = 1; v <= a->size; v++) a->values[v] = engine->model_value(v);
+            }
+            for (int i = 0; i < shared->threads; i++)
+                if (shared->engines[i]) shared->engines[i]->interrupt();
+        }
+    }
+    delete engine;
+}
+
+// 最后一个到屏障的线程调用, 这时其他线程都在等, mutex在手上
+// 交换缓冲按线程编号的顺序写, 结果也按线程编号挑, 所以和调度无关
+static void finish_round(PortfolioShared* shared)
+{
+    if (shared->exchange) shared->exchange->flush_deferred();
+    for (int i = 0; i < shared->threads; i++) {
+        if (shared->round_result[i] == UNKNOWN) continue;
+        shared->winner = i;
+        shared->result = shared->round_result[i];
+        shared->done = TRUE;
+        return;
+    }
+
+    const SolverConfig* base = shared->base;
+    int running = 0;
+    for (int i = 0; i < shared->threads; i++) {
+        if (shared->finished[i]) continue;
+        SolverStats* s = &shared->stats[i];
+        StopReason why = STOP_NONE;
+        if (s->stop_reason == STOP_CANCELLED || s->stop_reason == STOP_MEMORY) why = s->stop_reason;
+        else if (base->conflict_limit > 0 && s->conflicts >= base->conflict_limit) why = STOP_CONFLICTS;
+        else if (base->decision_limit > 0 && s->decisions >= base->decision_limit) why = STOP_DECISIONS;
+        else if (base->propagation_limit > 0 && s->propagations >= base->propagation_limit) why = STOP_PROPAGATIONS;
+        if (why == STOP_NONE) {
+            running++;
+            continue;
+        }
+        shared->finished[i] = TRUE;
+        s->stop_reason = why;
+        if (shared->reason == STOP_NONE || why == STOP_CANCELLED) shared->reason = why;
+    }
+    if (shared->reason == STOP_CANCELLED || cancel_requested()) shared->reason = STOP_CANCELLED;
+    else if (shared->deadline > 0 && solver_wall_seconds() >= shared->deadline) shared->reason = STOP_TIME;
+    else if (running > 0) return;
+
+    shared->done = TRUE;
+    for (int i = 0; i < shared->threads; i++)
+        if (!shared->finished[i]) shared->stats[i].stop_reason = shared->reason;
+}
+
+static void deterministic_worker(PortfolioShared* shared, int index)
+{
+    TRACE_THREAD_NAME("portfolio", index);
+    double t0 = solver_wall_seconds();
+    // 每轮 resume 一段传播, 赋值留着下一轮接着搜; 总预算在屏障处按统计检查, 时间预算也在那里看
+    SolverConfig config = shared->configs[index];
+    config.time_limit = 0;
+    config.conflict_limit = 0;
+    config.decision_limit = 0;
+    config.propagation_limit = 0;
+    SolverEngine* engine = NULL;
+    try {
+        engine = create_solver_engine(&config);
+    } catch (const std::bad_alloc&) {
+        engine = NULL;
+    }
+    if (engine) {
+        if (shared->exchange) engine->connect_exchange(shared->exchange, index);
+        const ClauseStore* store = shared->store;
+        for (int i = 0; i < store->num_clauses(); i++)
+            if (!engine->add_shared_clause(store->clause(i), store->clause_size(i))) break;
+    }
+
+    for (;;) {
+        // finished 只在屏障里改, 这里读不用加锁
+        int run = engine && !shared->finished[index];
+        SatResult r = UNKNOWN;
+        if (run) {
+            TRACE_SCOPE("round");
+            r = engine->resume(shared->sync);
+        }
+
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->round_result[index] = r;
+        if (run) shared->stats[index] = engine->stats();
+        else if (!engine) shared->finished[index] = TRUE;
+        {
+            TRACE_SCOPE("barrier wait");
+            if (++shared->arrived == shared->threads) {
+                finish_round(shared);
+                shared->arrived = 0;
+                shared->rounds++;
+                shared->round_cv.notify_all();
+            } else {
+                long long round = shared->rounds;
+                while (shared->rounds == round) shared->round_cv.wait(lock);
+            }
+        }
+        if (shared->done) {
+            if (shared->winner == index && shared->result == SAT) {
+                Assignment* a = shared->assignment;
+                for (int v = 1; v <= a->size; v++) a->values[v] = engine->model_value(v);
+            }
+            shared->thread_seconds += solver_wall_seconds() - t0;
+            break;
+        }
+    }
+    delete engine;
+}
+
+// sync 为0时是自由模式
+static SatResult portfolio_run(const CNF* cnf, Assignment* assignment, const SolverConfig* base,
+                               int threads, long long sync, PortfolioResult* result)
+{
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    if (result) {
+        memset(result, 0, sizeof(*result));
+        result->threads = threads;
+        result->winner = -1;
+        result->winner_config = *base;
+        result->winner_stats.stop_reason = STOP_MEMORY;
+    }
+
+    ClauseStore store;
+    if (!build_clause_store(&store, cnf)) return UNKNOWN;
+
+    PortfolioShared shared;
+    shared.store = &store;
+    shared.exchange = NULL;
+    if (base->share_lbd > 0 && threads > 1) {
+        shared.exchange = new (std::nothrow) ClauseExchange;
+        if (!shared.exchange) fprintf(stderr, "Memory Allocation Failed: clause exchange, solving without sharing\n");
+        if (shared.exchange && sync > 0 && !shared.exchange->defer(threads)) {
+            delete shared.exchange;
+            shared.exchange = NULL;
+        }
+    }
+    shared.threads = threads;
+    shared.winner = -1;
+    shared.result = UNKNOWN;
+    shared.assignment = assignment;
+    shared.thread_seconds = 0;
+    shared.base = base;
+    shared.sync = sync;
+    shared.arrived = 0;
+    shared.rounds = 0;
+    shared.done = FALSE;
+    shared.reason = STOP_NONE;
+    shared.deadline = base->time_limit > 0 ? solver_wall_seconds() + base->time_limit : 0;
+    shared.engines = new (std::nothrow) SolverEngine*[threads];
+    shared.configs = new (std::nothrow) SolverConfig[threads];
+    shared.stats = new (std::nothrow) SolverStats[threads];
+    shared.round_result = new (std::nothrow) SatResult[threads];
+    shared.finished = new (std::nothrow) int[threads];
+    std::thread* workers = new (std::nothrow) std::thread[threads];
+    if (!shared.engines || !shared.configs || !shared.stats || !shared.round_result || !shared.finished || !workers) {
+        fprintf(stderr, "Memory Allocation Failed: portfolio_solve\n");
+        delete[] shared.engines;
+        delete[] shared.configs;
+        delete[] shared.stats;
+        delete[] shared.round_result;
+        delete[] shared.finished;
+        delete[] workers;
+        delete shared.exchange;
+        return UNKNOWN;
+    }
+    for (int i = 0; i < threads; i++) {
+        shared.engines[i] = NULL;
+        shared.round_result[i] = UNKNOWN;
+        shared.finished[i] = FALSE;
+        portfolio_config(base, i, &shared.configs[i]);
+        memset(&shared.stats[i], 0, sizeof(SolverStats));
+        shared.stats[i].stop_reason = STOP_MEMORY;  // 没跑起来的线程
+    }
+
+    for (int i = 0; i < threads; i++)
+        workers[i] = sync > 0 ? std::thread(deterministic_worker, &shared, i) : std::thread(portfolio_worker, &shared, i);
+    for (int i = 0; i < threads; i++) workers[i].join();
+
+    if (result) {
+        int shown = shared.winner >= 0 ? shared.winner : 0;
+        result->winner = shared.winner;
+        result->winner_config = shared.configs[shown];
+        result->winner_stats = shared.stats[shown];
+        for (int i = 0; i < threads; i++) {
+            result->total_conflicts += shared.stats[i].conflicts;
+            result->total_propagations += shared.stats[i].propagations;
+        }
+        result->store_bytes = store.mem.peak_total;
+        result->exchange_bytes = shared.exchange ? (long long)sizeof(ClauseExchange) : 0;
+        result->thread_stats = (SolverStats*)malloc((size_t)threads * sizeof(SolverStats));
+        if (result->thread_stats) memcpy(result->thread_stats, shared.stats, (size_t)threads * sizeof(SolverStats));
+        result->rounds = shared.rounds;
+        result->thread_seconds = shared.thread_seconds;
+    }
+
+    delete[] workers;
+    delete[] shared.engines;
+    delete[] shared.configs;
+    delete[] shared.stats;
+    delete[] shared.round_result;
+    delete[] shared.finished;
+    delete shared.exchange;
+    return shared.result;
+}
+
+SatResult portfolio_solve(const CNF* cnf, Assignment* assignment, const SolverConfig* base,
+                          int threads, PortfolioResult* result)
+{
+    return portfolio_run(cnf, assignment, base, threads, 0, result);
+}
+
+SatResult portfolio_solve_deterministic(const CNF* cnf, Assignment* assignment, const SolverConfig* base,
+                                        int threads, long long sync_propagations, PortfolioResult* result)
+{
+    if (sync_propagations <= 0) sync_propagations = PORTFOLIO_SYNC_DEFAULT;
+    return portfolio_run(cnf, assignment, base, threads, sync_propagations, result);
+}
+
+void free_portfolio_result(PortfolioResult* result)
+{
+    free(result->thread_stats);
+    result->thread_stats = NULL;
+}
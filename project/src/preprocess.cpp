@@ -0,0 +1,236 @@
+#include "preprocess.h"
+#include "simplifier.h"
+#include "trace.h"
+#include <limits.h>
+
+void init_preprocess_options(PreprocessOptions* options)
+{
+    options->subsume = TRUE;
+    options->subsume_budget = 100000000LL;
+    options->probe = TRUE;
+    options->probe_budget = 20000000LL;
+    options->substitute = TRUE;
+    options->bce = TRUE;
+    options->cce = FALSE;
+    options->bce_budget = 100000000LL;
+    options->elim = TRUE;
+    options->elim_occ_limit = 100;
+    options->elim_resolvent_limit = 20;
+    options->elim_budget = 100000000LL;
+    options->gates = TRUE;
+    options->gate_budget = 20000000LL;
+    options->bva = FALSE;
+    options->bva_budget = 50000000LL;
+}
+
+void init_reconstruction(Reconstruction* recon)
+{
+    init_mem_tracker(&recon->mem, 0);
+}
+
+// 出现过的变量数, 子句数, 文字数
+static void count_formula(const CNF* cnf, int* vars, int* clauses, long long* lits)
+{
+    *vars = 0;
+    *clauses = cnf->clauses.size;
+    *lits = 0;
+    char* seen = (char*)calloc((size_t)cnf->num_variables + 1, 1);
+    for (int i = 0; i < cnf->clauses.size; i++) {
+        const LiteralArray* c = &cnf->clauses.data[i].literals;
+        *lits += c->size;
+        for (int k = 0; seen && k < c->size; k++) {
+            Variable v = lit_var(c->data[k]);
+            if (v > cnf->num_variables || seen[v]) continue;
+            seen[v] = 1;
+            (*vars)++;
+        }
+    }
+    free(seen);
+}
+
+int preprocess_cnf(const CNF* in, CNF* out, Reconstruction* recon, const PreprocessOptions* options,
+                   PreprocessStats* stats)
+{
+    TRACE_SCOPE("preprocess");
+    PreprocessStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    double t0 = solver_wall_seconds();
+    count_formula(in, &stats->vars_before, &stats->clauses_before, &stats->lits_before);
+
+    // 先让重建栈认准自己的记账, 之后在化简的 MemScope 里扩容也记在它身上
+    int recon_size = recon->stack.size();
+    try {
+        MemScope scope(&recon->mem);
+        recon->stack.reserve(recon_size + 64);
+    } catch (const MemoryExhausted&) {
+        return FALSE;
+    }
+
+    MemTracker mem;     // 化简用的数据结构, 比 Simplifier 先构造后析构
+    init_mem_tracker(&mem, 0);
+    Simplifier s;
+    int done = FALSE;
+    {
+        MemScope scope(&mem);
+        try {
+            simp_init(&s, in, &recon->stack, stats);
+            if (s.ok && options->subsume) simp_subsume(&s, options);
+            if (s.ok && options->probe) simp_probe(&s, options);
+            if (s.ok && options->gates) simp_hash_gates(&s, options);
+            if (s.ok && options->substitute) simp_substitute(&s);
+            if (s.ok && options->bce) simp_eliminate_blocked(&s, options);
+            if (s.ok && options->elim) {
+                int before = s.stats->eliminated;
+                simp_eliminate(&s, options);
+                // resolvent之间, resolvent和原来的子句之间还能再包含
+                if (s.ok && options->subsume && s.stats->eliminated > before) simp_subsume(&s, options);
+            }
+            if (s.ok && options->bva) simp_add_variables(&s, options);
+            done = TRUE;
+        } catch (const MemoryExhausted&) {
+            fprintf(stderr, "Memory Allocation Failed: preprocessing skipped\n");
+        }
+    }
+    if (done && !simp_output(&s, out, in->num_variables)) done = FALSE;
+    if (!done) {
+        recon->stack.shrink(recon_size);
+        return FALSE;
+    }
+
+    count_formula(out, &stats->vars_after, &stats->clauses_after, &stats->lits_after);
+    // 定下来的变量只出现在各自的单元子句里, 不算在化简后的公式里
+    if (s.ok) {
+        stats->fixed = s.units.size();
+        stats->vars_after -= stats->fixed;
+        stats->clauses_after -= stats->fixed;
+        stats->lits_after -= stats->fixed;
+    }
+    stats->seconds = solver_wall_seconds() - t0;
+    return TRUE;
+}
+
+void extend_model(const Reconstruction* recon, Assignment* assignment)
+{
+    const Vec<Literal, MEM_CLAUSES>& st = recon->stack;
+    for (int i = st.size() - 1; i >= 0; i -= st[i] + 1) {
+        int size = st[i];
+        const Literal* c = st.data() + i - size;
+        int satisfied = FALSE;
+        for (int k = 0; k < size && !satisfied; k++) {
+            Variable v = lit_var(c[k]);
+            if (v > assignment->size) continue;
+            satisfied = assignment->values[v] == (c[k] > 0 ? TRUE : FALSE);
+        }
+        Variable w = lit_var(c[0]);
+        if (!satisfied && w <= assignment->size) assignment->values[w] = c[0] > 0 ? TRUE : FALSE;
+    }
+}
+
+// =========== 重建文件 ===========
+
+static void put_varint(FILE* f, unsigned int x)
+{
+    while (x >= 0x80) {
+        fputc((int)(x & 0x7f) | 0x80, f);
+        x >>= 7;
+    }
+    fputc((int)x, f);
+}
+
+// 读到文件尾或者超过32位返回FALSE
+static int get_varint(FILE* f, unsigned int* out)
+{
+    unsigned int x = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF) return FALSE;
+        x |= (unsigned int)(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            *out = x;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static unsigned int zigzag(int x) { return x >= 0 ? 2u * (unsigned int)x : 2u * (unsigned int)(-(long long)x) - 1; }
+static int unzigzag(unsigned int x) { return (x & 1) ? -(int)((x + 1) / 2) : (int)(x / 2); }
+
+int save_reconstruction(const char* path, const Reconstruction* recon, int num_variables, int formula_variables)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Failed to create reconstruction file: %s\n", path);
+        return FALSE;
+    }
+    const Vec<Literal, MEM_CLAUSES>& st = recon->stack;
+    fwrite("SATR", 1, 4, f);
+    put_varint(f, RECON_FILE_VERSION);
+    put_varint(f, (unsigned int)num_variables);
+    put_varint(f, (unsigned int)formula_variables);
+    put_varint(f, (unsigned int)st.size());
+    for (int i = 0; i < st.size(); i++) put_varint(f, zigzag(st[i]));
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = FALSE;
+    if (!ok) fprintf(stderr, "Failed to write reconstruction file: %s\n", path);
+    return ok;
+}
+
+int load_reconstruction(const char* path, Reconstruction* recon, int* num_variables, int* formula_variables)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open reconstruction file: %s\n", path);
+        return FALSE;
+    }
+    char magic[4];
+    unsigned int version, vars, all_vars, size;
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "SATR", 4) != 0 || !get_varint(f, &version)) {
+        fprintf(stderr, "Not a reconstruction file: %s\n", path);
+        fclose(f);
+        return FALSE;
+    }
+    if (version != RECON_FILE_VERSION) {
+        fprintf(stderr, "Unsupported reconstruction file version %u: %s\n", version, path);
+        fclose(f);
+        return FALSE;
+    }
+    if (!get_varint(f, &vars) || !get_varint(f, &all_vars) || !get_varint(f, &size) ||
+        all_vars > (unsigned int)INT_MAX || vars > all_vars || size > (unsigned int)INT_MAX / 2) {
+        fprintf(stderr, "Corrupt reconstruction file: %s\n", path);
+        fclose(f);
+        return FALSE;
+    }
+
+    // 栈从后往前读: 每项最后是长度, 长度前面是这一项的文字, 都要在变量范围里
+    int base = recon->stack.size();
+    int ok = TRUE;
+    try {
+        MemScope scope(&recon->mem);
+        recon->stack.reserve(base + (int)size);
+        unsigned int x;
+        for (unsigned int i = 0; i < size && ok; i++) {
+            ok = get_varint(f, &x);
+            if (ok) recon->stack.push(unzigzag(x));
+        }
+    } catch (const MemoryExhausted&) {
+        ok = FALSE;
+    }
+    fclose(f);
+    const Vec<Literal, MEM_CLAUSES>& st = recon->stack;
+    for (int i = st.size() - 1; ok && i >= base;) {
+        int n = st[i];
+        ok = n >= 1 && n <= i - base;
+        for (int k = i - n; ok && k < i; k++) ok = st[k] != 0 && lit_var(st[k]) <= (int)all_vars;
+        if (ok) i -= n + 1;
+    }
+    if (!ok) {
+        fprintf(stderr, "Corrupt reconstruction file: %s\n", path);
+        recon->stack.shrink(base);
+        return FALSE;
+    }
+    *num_variables = (int)vars;
+    *formula_variables = (int)all_vars;
+    return TRUE;
+}
@@ -0,0 +1,199 @@
+#include "simplifier.h"
+
+// =========== 失败文字探测 ===========
+// 试着把一个文字设成真, 在出现表上做单元传播:
+//   传播出矛盾 -> 这个文字失败, 它的反面是第0层单元
+//   v 和 -v 都能推出 y -> y 是单元
+//   v 推出 y, -v 推出 -y -> v 和 y 等价, 记成两个二元子句
+// 只有反面出现在二元子句里的文字才可能推出东西(一次赋值只能让二元子句变成单元),
+// 二元蕴含图的根(本身不出现在二元子句里, 只有出边)先试, 它能到达的文字最多
+
+typedef struct {
+    Variable var;
+    int key;                    // 越小越先试
+} ProbeCandidate;
+
+static int compare_probe_candidates(const void* a, const void* b)
+{
+    const ProbeCandidate* x = (const ProbeCandidate*)a;
+    const ProbeCandidate* y = (const ProbeCandidate*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->var < y->var ? -1 : (x->var > y->var ? 1 : 0);
+}
+
+struct Prober {
+    Vec<Literal> trail;                 // 这次试探赋的值, 第一个是试探的文字
+    Vec<Literal> pos_trail;             // 正极性那次的 trail
+    Vec<Literal> units;                 // 两个极性都推出的文字
+    Vec<Literal> equivalent;            // 和被试变量等价的文字
+    Vec<signed char> implied;           // 按变量: 上一个极性推出的值, UNASSIGNED 表示没推出
+    Vec<int> bin_pos;                   // 按lit_index: 含这个文字的二元子句数
+    Vec<Literal> repr;                  // 按变量: 和正文字等价的文字, 自己指自己是代表; 已知等价的不再记
+    Vec<ProbeCandidate> order;
+    long long budget;                   // 还能看的子句数
+};
+
+// 在 s->val 上试探赋值并传播, 返回FALSE表示矛盾. 赋的值留在 trail 里, 调用者负责撤销
+static int probe(Simplifier* s, Prober* pr, Literal lit)
+{
+    pr->trail.clear();
+    s->val[lit_var(lit)] = (signed char)(lit > 0 ? TRUE : FALSE);
+    pr->trail.push(lit);
+    for (int head = 0; head < pr->trail.size(); head++) {
+        const Vec<int>& occ = s->occurs[lit_index(-pr->trail[head])];
+        pr->budget -= occ.size();
+        for (int i = 0; i < occ.size(); i++) {
+            const Literal* p = simp_lits(s, occ[i]);
+            int n = s->clauses[occ[i]].size;
+            Literal unit = 0;
+            int open = 0, satisfied = FALSE;
+            for (int k = 0; k < n && !satisfied && open < 2; k++) {
+                int v = simp_value(s, p[k]);
+                if (v == TRUE) satisfied = TRUE;
+                else if (v == UNASSIGNED) {
+                    unit = p[k];
+                    open++;
+                }
+            }
+            if (satisfied || open >= 2) continue;
+            if (open == 0) return FALSE;
+            s->val[lit_var(unit)] = (signed char)(unit > 0 ? TRUE : FALSE);
+            pr->trail.push(unit);
+        }
+    }
+    return TRUE;
+}
+
+static void undo_probe(Simplifier* s, Prober* pr)
+{
+    for (int i = 0; i < pr->trail.size(); i++) s->val[lit_var(pr->trail[i])] = (signed char)UNASSIGNED;
+}
+
+// a, b 两个文字的二元子句已经有了就不再加
+static int has_binary(Simplifier* s, Literal a, Literal b)
+{
+    const Vec<int>& occ = s->occurs[lit_index(a)];
+    for (int i = 0; i < occ.size(); i++) {
+        const SimpClause& c = s->clauses[occ[i]];
+        if (c.size != 2) continue;
+        const Literal* p = simp_lits(s, occ[i]);
+        if (p[0] == b || p[1] == b) return TRUE;
+    }
+    return FALSE;
+}
+
+static Literal find_repr(const Prober* pr, Literal lit)
+{
+    while (pr->repr[lit_var(lit)] != lit_var(lit)) lit = lit > 0 ? pr->repr[lit] : -pr->repr[-lit];
+    return lit;
+}
+
+// 记下 a 和 b 等价, 已经知道的返回FALSE; a 和 -b 已经等价说明公式矛盾
+static int union_repr(Simplifier* s, Prober* pr, Literal a, Literal b)
+{
+    Literal ra = find_repr(pr, a), rb = find_repr(pr, b);
+    if (ra == rb) return FALSE;
+    if (ra == -rb) {
+        s->ok = FALSE;
+        return FALSE;
+    }
+    if (rb > 0) pr->repr[rb] = ra;
+    else pr->repr[-rb] = -ra;
+    return TRUE;
+}
+
+// 第0层单元赋值并传播, 已经为真的不管
+static void probe_unit(Simplifier* s, Literal lit)
+{
+    int v = simp_value(s, lit);
+    if (v == FALSE) s->ok = FALSE;
+    else if (v == UNASSIGNED) simp_assign(s, lit);
+}
+
+static void probe_variable(Simplifier* s, Prober* pr, Variable v)
+{
+    // 正极性: 推出的值记在 implied 上
+    if (!probe(s, pr, v)) {
+        undo_probe(s, pr);
+        probe_unit(s, -v);
+        s->stats->failed_literals++;
+        simp_propagate(s);
+        return;
+    }
+    undo_probe(s, pr);
+    pr->trail.copy_to(pr->pos_trail);
+    for (int i = 1; i < pr->pos_trail.size(); i++) {
+        Literal y = pr->pos_trail[i];
+        pr->implied[lit_var(y)] = (signed char)(y > 0 ? TRUE : FALSE);
+    }
+
+    // 负极性: 和正极性推出的值比较
+    pr->units.clear();
+    pr->equivalent.clear();
+    int failed = !probe(s, pr, -v);
+    if (!failed) {
+        for (int i = 1; i < pr->trail.size(); i++) {
+            Literal y = pr->trail[i];
+            int was = pr->implied[lit_var(y)];
+            if (was == UNASSIGNED) continue;
+            if (was == (y > 0 ? TRUE : FALSE)) pr->units.push(y);
+            else pr->equivalent.push(-y);   // v 推出 -y, -v 推出 y: v 和 -y 等价
+        }
+    }
+    undo_probe(s, pr);
+    for (int i = 1; i < pr->pos_trail.size(); i++) pr->implied[lit_var(pr->pos_trail[i])] = (signed char)UNASSIGNED;
+
+    if (failed) {
+        probe_unit(s, v);
+        s->stats->failed_literals++;
+    }
+    for (int i = 0; i < pr->units.size() && s->ok; i++) {
+        probe_unit(s, pr->units[i]);
+        s->stats->probe_units++;
+    }
+    // v 和 e 等价: (-v e) (v -e). 一个等价类只记一棵生成树, 不然类里两两都要加
+    for (int i = 0; i < pr->equivalent.size() && s->ok; i++) {
+        Literal e = pr->equivalent[i];
+        if (simp_value(s, e) != UNASSIGNED || simp_value(s, v) != UNASSIGNED) continue;
+        if (!union_repr(s, pr, v, e)) continue;
+        Literal a[2] = { -v, e }, b[2] = { v, -e };
+        if (!has_binary(s, -v, e)) simp_add_clause(s, a, 2);
+        if (!has_binary(s, v, -e)) simp_add_clause(s, b, 2);
+        s->stats->probe_equivalences++;
+    }
+    simp_propagate(s);
+}
+
+void simp_probe(Simplifier* s, const PreprocessOptions* options)
+{
+    Prober pr;
+    pr.budget = options->probe_budget;
+    pr.implied.grow_to(s->num_vars + 1, (signed char)UNASSIGNED);
+    for (Variable v = 0; v <= s->num_vars; v++) pr.repr.push(v);
+    pr.bin_pos.grow_to(2 * s->num_vars + 2, 0);
+    for (int i = 0; i < s->clauses.size(); i++) {
+        const SimpClause& c = s->clauses[i];
+        if (c.deleted || c.size != 2) continue;
+        const Literal* p = simp_lits(s, i);
+        pr.bin_pos[lit_index(p[0])]++;
+        pr.bin_pos[lit_index(p[1])]++;
+    }
+    // 文字l的出边数是 bin_pos[-l], 入边数是 bin_pos[l]
+    for (Variable v = 1; v <= s->num_vars; v++) {
+        if (s->val[v] != UNASSIGNED || s->eliminated[v]) continue;
+        int pos = pr.bin_pos[lit_index(v)], neg = pr.bin_pos[lit_index(-v)];
+        if (pos + neg == 0) continue;
+        // 有一个极性是根的排最前, 同类里出边多的先试
+        int rank = (pos == 0 || neg == 0) ? 0 : 1;
+        ProbeCandidate pc = { v, rank * (1 << 24) - (pos + neg) };
+        pr.order.push(pc);
+    }
+    qsort(pr.order.data(), pr.order.size(), sizeof(ProbeCandidate), compare_probe_candidates);
+
+    for (int i = 0; i < pr.order.size() && s->ok && pr.budget > 0; i++) {
+        Variable v = pr.order[i].var;
+        if (s->val[v] != UNASSIGNED || s->eliminated[v]) continue;
+        s->stats->probed++;
+        probe_variable(s, &pr, v);
+    }
+}
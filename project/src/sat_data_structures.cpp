@@ -3,41 +3,48 @@
 // =========== 动态数组操作实现 ===========
 
 // LiteralArray操作
-void init_literal_array(LiteralArray* arr)
+// 分配都走 mem_track, 记在当前线程的记账上; 失败时打印位置并返回FALSE, 不再直接exit
+int init_literal_array(LiteralArray* arr)
 {
     // 初始化数组容量为4
     arr->capacity = 4;
     arr->size = 0;
     
     // 分配
-    arr->data = (Literal*)malloc(arr->capacity * sizeof(Literal));
+    arr->data = (Literal*)mem_alloc(NULL, arr->capacity * sizeof(Literal), MEM_CLAUSES);
     if (!arr->data) 
     {
         // fprintf(stderr, "内存分配失败: init_literal_array\n");
         fprintf(stderr, "Memory Allocation Failed: init_literal_array\n");
-        exit(1); // 强制终止, 因为有时候退不出来
+        arr->capacity = 0;
+        return FALSE;
     }
+    return TRUE;
 }
 
-void push_literal(LiteralArray* arr, Literal lit)
+int push_literal(LiteralArray* arr, Literal lit)
 {
     if (arr->size >= arr->capacity) {
-        arr->capacity *= 2; // 每次翻两倍
-        arr->data = (Literal*)realloc(arr->data, arr->capacity * sizeof(Literal));
-        if (!arr->data)
+        int cap = arr->capacity > 0 ? arr->capacity * 2 : 4; // 每次翻两倍
+        Literal* p = (Literal*)mem_realloc(NULL, arr->data, arr->capacity * sizeof(Literal),
+                                           cap * sizeof(Literal), MEM_CLAUSES);
+        if (!p)
         {
             // fprintf(stderr, "内存重分配失败: push_literal\n");
-            fprintf(stderr, "Memory Reallocation Failed: push_literal\n");
-            exit(1);
+            fprintf(stderr, "Memory Reallocation Failed: push_literal (%d literals)\n", arr->size);
+            return FALSE; // 原来的数组还在
         }
+        arr->data = p;
+        arr->capacity = cap;
     }
     arr->data[arr->size++] = lit;
+    return TRUE;
 }
 
 void free_literal_array(LiteralArray* arr)
 {
     if (arr->data) {
-        free(arr->data);
+        mem_free(NULL, arr->data, arr->capacity * sizeof(Literal), MEM_CLAUSES);
     }
     arr->data = NULL;
     arr->size = 0;
@@ -55,45 +62,47 @@ int is_empty_literal_array(const LiteralArray* arr)
 }
 
 // ClauseArray操作: 和Literal的操作完全一样
-void init_clause_array(ClauseArray* arr)
+int init_clause_array(ClauseArray* arr)
 {
     arr->capacity = 16;
     arr->size = 0;
-    arr->data = (Clause*)malloc(arr->capacity * sizeof(Clause));
+    arr->data = (Clause*)mem_alloc(NULL, arr->capacity * sizeof(Clause), MEM_CLAUSES);
     if (!arr->data) {
         // fprintf(stderr, "内存分配失败: init_clause_array\n");
         fprintf(stderr, "Memory Allocation Failed: init_clause_array\n");
-        exit(1);
+        arr->capacity = 0;
+        return FALSE;
     }
+    return TRUE;
 }
 
-void push_clause(ClauseArray* arr, const Clause* clause)
+int push_clause(ClauseArray* arr, const Clause* clause)
 {
     if (arr->size >= arr->capacity)
     {
-        arr->capacity *= 2;
-        arr->data = (Clause*)realloc(arr->data, arr->capacity * sizeof(Clause));
-        if (!arr->data)
+        int cap = arr->capacity > 0 ? arr->capacity * 2 : 16;
+        Clause* p = (Clause*)mem_realloc(NULL, arr->data, arr->capacity * sizeof(Clause),
+                                         cap * sizeof(Clause), MEM_CLAUSES);
+        if (!p)
         {
             // fprintf(stderr, "内存重分配失败: push_clause\n");
-            fprintf(stderr, "Memory Reallocation Failed: push_clause\n");
-            exit(1);
+            fprintf(stderr, "Memory Reallocation Failed: push_clause (%d clauses)\n", arr->size);
+            return FALSE;
         }
+        arr->data = p;
+        arr->capacity = cap;
     }
     // 深拷贝子句
-    init_literal_array(&arr->data[arr->size].literals);
-    for (int i = 0; i < clause->literals.size; i++)
-    {
-        push_literal(&arr->data[arr->size].literals, clause->literals.data[i]);
-    }
+    if (!copy_clause(&arr->data[arr->size], clause)) return FALSE;
     arr->size++;
+    return TRUE;
 }
 
 void free_clause_array(ClauseArray* arr)
 {
     // 先清理子句
     for (int i = 0; i < arr->size; i++) free_literal_array(&arr->data[i].literals);
-    if (arr->data) free(arr->data);
+    if (arr->data) mem_free(NULL, arr->data, arr->capacity * sizeof(Clause), MEM_CLAUSES);
     arr->data = NULL;
     arr->size = 0;
     arr->capacity = 0;
@@ -111,11 +120,11 @@ int is_empty_clause_array(const ClauseArray* arr)
 
 // =========== CNF公式操作实现 ===========
 
-void init_cnf(CNF* cnf)
+int init_cnf(CNF* cnf)
 {
-    init_clause_array(&cnf->clauses);
     cnf->num_variables = 0;
     cnf->num_clauses = 0;
+    return init_clause_array(&cnf->clauses);
 }
 
 void free_cnf(CNF* cnf)
@@ -131,14 +140,19 @@ void clear_cnf(CNF* cnf)
     cnf->num_clauses = 0;
 }
 
-void copy_cnf(CNF* dest, const CNF* src) {
-    init_cnf(dest);
+int copy_cnf(CNF* dest, const CNF* src) {
+    if (!init_cnf(dest)) return FALSE;
     dest->num_variables = src->num_variables;
     dest->num_clauses = src->num_clauses;
     
     for (int i = 0; i < src->clauses.size; i++) {
-        push_clause(&dest->clauses, &src->clauses.data[i]);
+        if (!push_clause(&dest->clauses, &src->clauses.data[i])) {
+            // 失败时dest整个释放掉, 不留半个公式
+            free_cnf(dest);
+            return FALSE;
+        }
     }
+    return TRUE;
 }
 
 int is_cnf_empty(const CNF* cnf)
@@ -148,9 +162,9 @@ int is_cnf_empty(const CNF* cnf)
 
 // =========== 子句操作实现 ===========
 
-void init_clause(Clause* clause)
+int init_clause(Clause* clause)
 {
-    init_literal_array(&clause->literals);
+    return init_literal_array(&clause->literals);
 }
 
 void free_clause(Clause* clause)
@@ -158,11 +172,16 @@ void free_clause(Clause* clause)
     free_literal_array(&clause->literals);
 }
 
-void copy_clause(Clause* dest, const Clause* src)
+int copy_clause(Clause* dest, const Clause* src)
 {
-    init_literal_array(&dest->literals);
-    for (int i = 0; i < src->literals.size; i++)
-        push_literal(&dest->literals, src->literals.data[i]);
+    if (!init_literal_array(&dest->literals)) return FALSE;
+    for (int i = 0; i < src->literals.size; i++) {
+        if (!push_literal(&dest->literals, src->literals.data[i])) {
+            free_literal_array(&dest->literals);
+            return FALSE;
+        }
+    }
+    return TRUE;
 }
 
 int is_clause_empty(const Clause* clause)
@@ -177,36 +196,40 @@ int is_unit_clause(const Clause* clause)
 
 // =========== 赋值操作实现 ===========
 
-void init_assignment(Assignment* assign, int num_variables)
+int init_assignment(Assignment* assign, int num_variables)
 {
     assign->size = num_variables;
-    assign->values = (int*)malloc((num_variables + 1) * sizeof(int)); // 1-indexed
+    assign->values = (int*)mem_alloc(NULL, (num_variables + 1) * sizeof(int), MEM_TRAIL); // 1-indexed
     if (!assign->values) {
-        fprintf(stderr, "Memory Allocation Failed: init_assignment\n");
-        exit(1); // 全部替换为强制退出
+        fprintf(stderr, "Memory Allocation Failed: init_assignment (%d variables)\n", num_variables);
+        assign->size = 0;
+        return FALSE;
     }
     for (int i = 0; i <= num_variables; i++) assign->values[i] = UNASSIGNED;
+    return TRUE;
 }
 
 void free_assignment(Assignment* assign) {
     if (assign->values) {
-        free(assign->values);
+        mem_free(NULL, assign->values, (assign->size + 1) * sizeof(int), MEM_TRAIL);
     }
     assign->values = NULL;
     assign->size = 0;
 }
 
-void copy_assignment(Assignment* dest, const Assignment* src) {
+int copy_assignment(Assignment* dest, const Assignment* src) {
     dest->size = src->size;
-    dest->values = (int*)malloc((src->size + 1) * sizeof(int));
+    dest->values = (int*)mem_alloc(NULL, (src->size + 1) * sizeof(int), MEM_TRAIL);
     if (!dest->values) {
         // fprintf(stderr, "内存分配失败: copy_assignment\n");
         fprintf(stderr, "Memory Allocation Failed: copy_assignment\n");
-        exit(1);
+        dest->size = 0;
+        return FALSE;
     }
     for (int i = 0; i <= src->size; i++) {
         dest->values[i] = src->values[i];
     }
+    return TRUE;
 }
 
 void clear_assignment(Assignment* assign) {
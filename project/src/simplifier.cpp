@@ -0,0 +1,180 @@
+#include "simplifier.h"
+
+void simp_init(Simplifier* s, const CNF* cnf, Vec<Literal, MEM_CLAUSES>* recon, PreprocessStats* stats)
+{
+    int n = cnf->num_variables;
+    for (int i = 0; i < cnf->clauses.size; i++) {
+        const LiteralArray* c = &cnf->clauses.data[i].literals;
+        for (int k = 0; k < c->size; k++)
+            if (lit_var(c->data[k]) > n) n = lit_var(c->data[k]);
+    }
+    s->num_vars = n;
+    s->ok = TRUE;
+    s->num_clauses = 0;
+    s->units_head = 0;
+    s->recon = recon;
+    s->stats = stats;
+    s->occurs.grow_to(2 * n + 2);
+    s->val.grow_to(n + 1, (signed char)UNASSIGNED);
+    s->eliminated.grow_to(n + 1, 0);
+    s->mark.grow_to(2 * n + 2, 0);
+
+    for (int i = 0; i < cnf->clauses.size && s->ok; i++) {
+        const LiteralArray* c = &cnf->clauses.data[i].literals;
+        simp_add_clause(s, c->data, c->size);
+    }
+    simp_propagate(s);
+}
+
+// lits 不能指向 s->lits 里面, 加的时候可能搬家
+int simp_add_clause(Simplifier* s, const Literal* lits, int size)
+{
+    if (!s->ok) return -1;
+    int start = s->lits.size();
+    int satisfied = FALSE;
+    for (int i = 0; i < size && !satisfied; i++) {
+        Literal l = lits[i];
+        int v = simp_value(s, l);
+        if (v == TRUE) satisfied = TRUE;
+        else if (v == FALSE || s->mark[lit_index(l)]) continue;
+        else if (s->mark[lit_index(-l)]) satisfied = TRUE;     // 重言式
+        else {
+            s->mark[lit_index(l)] = 1;
+            s->lits.push(l);
+        }
+    }
+    for (int k = start; k < s->lits.size(); k++) s->mark[lit_index(s->lits[k])] = 0;
+    int n = s->lits.size() - start;
+    if (satisfied || n <= 1) {
+        Literal unit = n == 1 ? s->lits[start] : 0;
+        s->lits.shrink(start);
+        if (satisfied) return -1;
+        if (n == 0) s->ok = FALSE;
+        else simp_assign(s, unit);
+        return -1;
+    }
+
+    SimpClause c;
+    c.start = start;
+    c.size = n;
+    c.sig = 0;
+    c.deleted = 0;
+    for (int k = 0; k < n; k++) c.sig |= lit_signature(s->lits[start + k]);
+    s->clauses.push(c);
+    int cref = s->clauses.size() - 1;
+    s->num_clauses++;
+    for (int k = 0; k < n; k++) s->occurs[lit_index(s->lits[start + k])].push(cref);
+    return cref;
+}
+
+static void remove_occurrence(Simplifier* s, Literal lit, int cref)
+{
+    Vec<int>& occ = s->occurs[lit_index(lit)];
+    for (int i = 0; i < occ.size(); i++) {
+        if (occ[i] != cref) continue;
+        occ[i] = occ.last();
+        occ.pop();
+        return;
+    }
+}
+
+void simp_remove_clause(Simplifier* s, int cref)
+{
+    SimpClause& c = s->clauses[cref];
+    if (c.deleted) return;
+    const Literal* p = simp_lits(s, cref);
+    for (int k = 0; k < c.size; k++) remove_occurrence(s, p[k], cref);
+    c.deleted = 1;
+    s->num_clauses--;
+}
+
+void simp_strengthen(Simplifier* s, int cref, Literal lit)
+{
+    SimpClause& c = s->clauses[cref];
+    Literal* p = simp_lits(s, cref);
+    for (int k = 0; k < c.size; k++) {
+        if (p[k] != lit) continue;
+        p[k] = p[c.size - 1];
+        c.size--;
+        break;
+    }
+    remove_occurrence(s, lit, cref);
+    c.sig = 0;
+    for (int k = 0; k < c.size; k++) c.sig |= lit_signature(p[k]);
+    if (c.size > 1) return;
+
+    Literal unit = p[0];
+    simp_remove_clause(s, cref);
+    int v = simp_value(s, unit);
+    if (v == FALSE) s->ok = FALSE;
+    else if (v == UNASSIGNED) simp_assign(s, unit);
+}
+
+void simp_assign(Simplifier* s, Literal lit)
+{
+    s->val[lit_var(lit)] = (signed char)(lit > 0 ? TRUE : FALSE);
+    s->units.push(lit);
+}
+
+int simp_propagate(Simplifier* s)
+{
+    while (s->ok && s->units_head < s->units.size()) {
+        Literal l = s->units[s->units_head++];
+        // 满足的子句删掉, 假文字去掉; 两个函数都会把子句从这张出现表里摘掉
+        Vec<int>& sat = s->occurs[lit_index(l)];
+        while (sat.size() > 0) simp_remove_clause(s, sat.last());
+        Vec<int>& falsified = s->occurs[lit_index(-l)];
+        while (s->ok && falsified.size() > 0) simp_strengthen(s, falsified.last(), -l);
+    }
+    return s->ok;
+}
+
+void simp_push_recon(Simplifier* s, int cref, Literal witness)
+{
+    simp_push_recon_lits(s, simp_lits(s, cref), s->clauses[cref].size, witness);
+}
+
+void simp_push_recon_lits(Simplifier* s, const Literal* lits, int size, Literal witness)
+{
+    s->recon->push(witness);
+    for (int k = 0; k < size; k++)
+        if (lits[k] != witness) s->recon->push(lits[k]);
+    s->recon->push(size);
+}
+
+// 在调用者的记账下分配, 不要放在化简用的 MemScope 里
+int simp_output(Simplifier* s, CNF* out, int num_variables)
+{
+    if (!init_cnf(out)) return FALSE;
+    out->num_variables = num_variables > s->num_vars ? num_variables : s->num_vars;
+    Clause clause;
+    if (!init_clause(&clause)) {
+        free_cnf(out);
+        return FALSE;
+    }
+    int ok = TRUE;
+    if (!s->ok) {
+        // 已经矛盾: 只写一个空子句
+        ok = push_clause(&out->clauses, &clause);
+    } else {
+        for (int i = 0; i < s->units.size() && ok; i++) {
+            clear_literal_array(&clause.literals);
+            ok = push_literal(&clause.literals, s->units[i]) && push_clause(&out->clauses, &clause);
+        }
+        for (int i = 0; i < s->clauses.size() && ok; i++) {
+            const SimpClause& c = s->clauses[i];
+            if (c.deleted) continue;
+            clear_literal_array(&clause.literals);
+            const Literal* p = simp_lits(s, i);
+            for (int k = 0; k < c.size && ok; k++) ok = push_literal(&clause.literals, p[k]);
+            if (ok) ok = push_clause(&out->clauses, &clause);
+        }
+    }
+    free_clause(&clause);
+    if (!ok) {
+        free_cnf(out);
+        return FALSE;
+    }
+    out->num_clauses = out->clauses.size;
+    return TRUE;
+}
@@ -0,0 +1,331 @@
+#include "solve_jobs.h"
+#include "libsat.h"
+#include "vec.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// =========== 作业 ===========
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE
+} JobState;
+
+struct SolveJob {
+    MemTracker mem;                 // 作业自己的记账: 复制的子句和模型, 必须在Vec之前声明
+    Vec<Literal> lits;              // 复制的子句, 每个子句以0结尾
+    Vec<signed char> model;         // SAT时的模型, 按变量
+    SolverConfig config;
+
+    std::mutex mutex;               // 保护下面几项
+    std::condition_variable done_cv;
+    JobState state;
+    int cancelled;
+    SatSolver* solver;              // 正在跑时非NULL, 取消时用
+    SatResult result;
+    SolverStats stats;
+
+    std::atomic<int> refs;          // 调用者一份, 线程池一份
+    SolveJob* next;                 // 排队用
+};
+
+static void release_ref(SolveJob* job)
+{
+    if (job->refs.fetch_sub(1) == 1) delete job;
+}
+
+// 写结果并唤醒等待的线程
+static void finish_job(SolveJob* job, SatResult result, const SolverStats* stats)
+{
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->result = result;
+    if (stats) job->stats = *stats;
+    job->state = JOB_DONE;
+    job->done_cv.notify_all();
+}
+
+static void run_job(SolveJob* job)
+{
+    SolverStats stats;
+    memset(&stats, 0, sizeof(stats));
+    int cancelled;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        cancelled = job->cancelled;
+        if (!cancelled) job->state = JOB_RUNNING;
+    }
+    if (cancelled) {
+        // 还没开始就被取消了
+        stats.stop_reason = STOP_CANCELLED;
+        finish_job(job, UNKNOWN, &stats);
+        return;
+    }
+
+    SatSolver* solver = sat_solver_new(&job->config);
+    if (!solver) {
+        stats.stop_reason = STOP_MEMORY;
+        finish_job(job, UNKNOWN, &stats);
+        return;
+    }
+    const Literal* lits = job->lits.data();
+    for (int begin = 0, i = 0; i < job->lits.size(); i++) {
+        if (lits[i] != 0) continue;
+        if (!sat_add_clause(solver, lits + begin, i - begin)) break;
+        begin = i + 1;
+    }
+
+    // 加子句期间来的取消也要生效
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->solver = solver;
+        if (job->cancelled) sat_interrupt(solver);
+    }
+    SatResult result = sat_solve(solver);
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->solver = NULL;
+    }
+
+    if (result == SAT) {
+        MemScope scope(&job->mem);
+        int n = sat_num_variables(solver);
+        try {
+            job->model.grow_to(n + 1, (signed char)FALSE);
+            for (Variable v = 1; v <= n; v++) job->model[v] = (signed char)sat_model_value(solver, v);
+        } catch (const MemoryExhausted&) {
+            result = UNKNOWN;
+        }
+    }
+    stats = *sat_stats(solver);
+    if (result == UNKNOWN && stats.stop_reason == STOP_NONE) stats.stop_reason = STOP_MEMORY;
+    sat_solver_delete(solver);
+    finish_job(job, result, &stats);
+}
+
+// =========== 线程池 ===========
+// 进程里只有一个, 第一次提交时启动, 进程退出时取消剩下的作业并回收线程
+
+class JobPool {
+public:
+    JobPool() : head_(NULL), tail_(NULL), stopping_(FALSE), threads_(NULL), running_(NULL), count_(0) {}
+
+    ~JobPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = TRUE;
+            // 排队的直接结束, 跑着的打断
+            while (head_) {
+                SolveJob* job = head_;
+                head_ = job->next;
+                finish_cancelled(job);
+            }
+            tail_ = NULL;
+            for (int i = 0; i < count_; i++)
+                if (running_[i]) interrupt(running_[i]);
+        }
+        cv_.notify_all();
+        for (int i = 0; i < count_; i++) threads_[i].join();
+        delete[] threads_;
+        delete[] running_;
+    }
+
+    // 已经启动返回FALSE
+    int start(int workers)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ > 0) return FALSE;
+        if (workers <= 0) workers = (int)std::thread::hardware_concurrency();
+        if (workers <= 0) workers = 1;
+        running_ = new SolveJob*[workers];
+        threads_ = new std::thread[workers];
+        for (int i = 0; i < workers; i++) {
+            running_[i] = NULL;
+            threads_[i] = std::thread(&JobPool::worker, this, i);
+        }
+        count_ = workers;
+        return TRUE;
+    }
+
+    void submit(SolveJob* job)
+    {
+        start(0);   // 没有调用过 sat_jobs_init 时按默认大小启动
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job->next = NULL;
+            if (tail_) tail_->next = job;
+            else head_ = job;
+            tail_ = job;
+        }
+        cv_.notify_one();
+    }
+
+    // 还在队列里的摘下来直接结束, 否则交给正在跑它的线程在检查点停下
+    void cancel(SolveJob* job)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SolveJob* prev = NULL;
+        for (SolveJob* p = head_; p; prev = p, p = p->next) {
+            if (p != job) continue;
+            if (prev) prev->next = job->next;
+            else head_ = job->next;
+            if (tail_ == job) tail_ = prev;
+            finish_cancelled(job);
+            return;
+        }
+        interrupt(job);
+    }
+
+private:
+    // 调用时持有 mutex_, 作业已经不在队列里; 放掉线程池那一份引用
+    static void finish_cancelled(SolveJob* job)
+    {
+        SolverStats stats;
+        memset(&stats, 0, sizeof(stats));
+        stats.stop_reason = STOP_CANCELLED;
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->cancelled = TRUE;
+        }
+        finish_job(job, UNKNOWN, &stats);
+        release_ref(job);
+    }
+
+    static void interrupt(SolveJob* job)
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->cancelled = TRUE;
+        if (job->solver) sat_interrupt(job->solver);
+    }
+
+    void worker(int index)
+    {
+        for (;;) {
+            SolveJob* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (!head_ && !stopping_) cv_.wait(lock);
+                if (!head_) return;
+                job = head_;
+                head_ = job->next;
+                if (!head_) tail_ = NULL;
+                running_[index] = job;
+            }
+            run_job(job);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_[index] = NULL;
+            }
+            release_ref(job);
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    SolveJob* head_;
+    SolveJob* tail_;
+    int stopping_;
+    std::thread* threads_;
+    SolveJob** running_;        // 每个线程正在跑的作业
+    int count_;
+};
+
+static JobPool& job_pool()
+{
+    static JobPool pool;
+    return pool;
+}
+
+// =========== 对外接口 ===========
+
+int sat_jobs_init(int workers)
+{
+    return job_pool().start(workers);
+}
+
+SolveJob* sat_job_submit(const CNF* cnf, const SolverConfig* config)
+{
+    SolveJob* job = new (std::nothrow) SolveJob;
+    if (!job) {
+        fprintf(stderr, "Memory Allocation Failed: sat_job_submit\n");
+        return NULL;
+    }
+    init_mem_tracker(&job->mem, 0);
+    if (config) job->config = *config;
+    else init_solver_config(&job->config);
+    job->state = JOB_QUEUED;
+    job->cancelled = FALSE;
+    job->solver = NULL;
+    job->result = UNKNOWN;
+    memset(&job->stats, 0, sizeof(job->stats));
+    job->refs.store(2);
+    job->next = NULL;
+
+    // 子句复制到作业自己的数组里, 调用者马上就可以释放cnf
+    try {
+        MemScope scope(&job->mem);
+        for (int i = 0; i < cnf->clauses.size; i++) {
+            const LiteralArray* c = &cnf->clauses.data[i].literals;
+            for (int k = 0; k < c->size; k++) job->lits.push(c->data[k]);
+            job->lits.push(0);
+        }
+    } catch (const MemoryExhausted&) {
+        delete job;
+        return NULL;
+    }
+
+    job_pool().submit(job);
+    return job;
+}
+
+int sat_job_poll(SolveJob* job, SatResult* result)
+{
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (job->state != JOB_DONE) return FALSE;
+    if (result) *result = job->result;
+    return TRUE;
+}
+
+SatResult sat_job_wait(SolveJob* job)
+{
+    std::unique_lock<std::mutex> lock(job->mutex);
+    while (job->state != JOB_DONE) job->done_cv.wait(lock);
+    return job->result;
+}
+
+int sat_job_wait_for(SolveJob* job, double seconds)
+{
+    std::unique_lock<std::mutex> lock(job->mutex);
+    std::chrono::steady_clock::time_point until =
+        std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(seconds * 1e6));
+    while (job->state != JOB_DONE)
+        if (job->done_cv.wait_until(lock, until) == std::cv_status::timeout) break;
+    return job->state == JOB_DONE;
+}
+
+void sat_job_cancel(SolveJob* job)
+{
+    job_pool().cancel(job);
+}
+
+int sat_job_model_value(const SolveJob* job, Variable var)
+{
+    if (var <= 0 || var >= job->model.size()) return FALSE;
+    return job->model[var];
+}
+
+const SolverStats* sat_job_stats(const SolveJob* job)
+{
+    return &job->stats;
+}
+
+void sat_job_release(SolveJob* job)
+{
+    if (!job) return;
+    job_pool().cancel(job);
+    release_ref(job);
+}
@@ -0,0 +1,206 @@
+#include "search_engine.h"
+#include <signal.h>
+#include <chrono>
+
+// =========== 配置 ===========
+
+static const char* const heuristic_names[HEURISTIC_COUNT] = { "vsids", "jw" };
+static const char* const propagation_names[PROPAGATION_COUNT] = { "watched", "counting" };
+static const char* const restart_names[RESTART_COUNT] = { "luby", "geometric", "none" };
+static const char* const phase_names[PHASE_COUNT] = { "false", "true", "random" };
+static const char* const inprocess_names[INPROCESS_COUNT] = { "Probe:", "Substitute:", "Subsume:", "Vivify:",
+                                                               "Eliminate:" };
+
+void init_solver_config(SolverConfig* config)
+{
+    config->heuristic = HEURISTIC_VSIDS;
+    config->propagation = PROPAGATION_WATCHED;
+    config->restart = RESTART_LUBY;
+    config->phase = PHASE_FALSE;
+    config->seed = 0;
+    config->mem_limit = 0;
+    config->time_limit = 0;
+    config->conflict_limit = 0;
+    config->decision_limit = 0;
+    config->propagation_limit = 0;
+    config->progress = NULL;
+    config->progress_user = NULL;
+    config->progress_interval = 1.0;
+    config->share_lbd = 2;
+    config->share_max_size = 8;
+    config->share_rate = 4;
+    config->inprocess_interval = 10000;
+    config->inprocess_mask = INPROCESS_ALL;
+    config->inprocess_effort = 100;
+}
+
+void init_solver_budget(SolverBudget* budget, const SolverConfig* config)
+{
+    budget->deadline = config->time_limit > 0 ? solver_wall_seconds() + config->time_limit : 0;
+    budget->conflict_limit = config->conflict_limit;
+    budget->decision_limit = config->decision_limit;
+    budget->propagation_limit = config->propagation_limit;
+    budget->conflicts.store(0);
+    budget->decisions.store(0);
+    budget->propagations.store(0);
+}
+
+// 在名字表里查找, 找不到返回-1
+static int find_name(const char* const* names, int count, const char* name)
+{
+    for (int i = 0; i < count; i++)
+        if (strcmp(names[i], name) == 0) return i;
+    return -1;
+}
+
+int parse_heuristic(const char* name, HeuristicKind* out)
+{
+    int i = find_name(heuristic_names, HEURISTIC_COUNT, name);
+    if (i < 0) return 0;
+    *out = (HeuristicKind)i;
+    return 1;
+}
+
+int parse_propagation(const char* name, PropagationKind* out)
+{
+    int i = find_name(propagation_names, PROPAGATION_COUNT, name);
+    if (i < 0) return 0;
+    *out = (PropagationKind)i;
+    return 1;
+}
+
+int parse_restart(const char* name, RestartKind* out)
+{
+    int i = find_name(restart_names, RESTART_COUNT, name);
+    if (i < 0) return 0;
+    *out = (RestartKind)i;
+    return 1;
+}
+
+int parse_phase(const char* name, PhaseKind* out)
+{
+    int i = find_name(phase_names, PHASE_COUNT, name);
+    if (i < 0) return 0;
+    *out = (PhaseKind)i;
+    return 1;
+}
+
+void describe_solver_config(const SolverConfig* config, char* buf, int size)
+{
+    int n = snprintf(buf, size, "%s/%s/%s", heuristic_names[config->heuristic],
+                     propagation_names[config->propagation], restart_names[config->restart]);
+    if (config->phase != PHASE_FALSE && n < size)
+        n += snprintf(buf + n, size - n, ", phase %s", phase_names[config->phase]);
+    if (config->seed != 0 && n < size)
+        snprintf(buf + n, size - n, ", seed %u", config->seed);
+}
+
+// =========== 实例化 ===========
+// 所有组合都在这里编译出来, 启动时按配置挑一个
+
+template <class H, class P, class R>
+static SolverEngine* make_engine(const SolverConfig* config)
+{
+    return new SearchEngine<H, P, R, BuildStats>(*config);
+}
+
+template <class H, class P>
+static SolverEngine* pick_restart(const SolverConfig* config)
+{
+    switch (config->restart) {
+        case RESTART_GEOMETRIC: return make_engine<H, P, GeometricRestart>(config);
+        case RESTART_NONE:      return make_engine<H, P, NoRestart>(config);
+        default:                return make_engine<H, P, LubyRestart>(config);
+    }
+}
+
+template <class H>
+static SolverEngine* pick_propagation(const SolverConfig* config)
+{
+    switch (config->propagation) {
+        case PROPAGATION_COUNTING: return pick_restart<H, CountingPropagation>(config);
+        default:                   return pick_restart<H, WatchedPropagation>(config);
+    }
+}
+
+SolverEngine* create_solver_engine(const SolverConfig* config)
+{
+    switch (config->heuristic) {
+        case HEURISTIC_JW: return pick_propagation<JwHeuristic>(config);
+        default:           return pick_propagation<VsidsHeuristic>(config);
+    }
+}
+
+// =========== 取消 ===========
+
+static volatile sig_atomic_t cancel_flag = 0;
+
+void request_cancel(void) { cancel_flag = 1; }
+int cancel_requested(void) { return cancel_flag != 0; }
+void reset_cancel(void) { cancel_flag = 0; }
+
+// 信号处理函数里只能做 async-signal-safe 的事: 写标志, 恢复默认处理
+static void on_cancel_signal(int sig)
+{
+    cancel_flag = 1;
+    signal(sig, SIG_DFL);
+}
+
+void install_cancel_handlers(void)
+{
+    signal(SIGINT, on_cancel_signal);
+    signal(SIGTERM, on_cancel_signal);
+}
+
+double solver_wall_seconds(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* const stop_reason_names[STOP_REASON_COUNT] = {
+    "none", "time limit", "conflict limit", "decision limit", "propagation limit",
+    "memory limit", "cancelled", "worker lost"
+};
+
+const char* stop_reason_name(StopReason reason)
+{
+    if (reason < 0 || reason >= STOP_REASON_COUNT) return "unknown";
+    return stop_reason_names[reason];
+}
+
+// =========== 统计输出 ===========
+
+void print_solver_progress(const SolverStats* stats, void*)
+{
+    printf("Solving... Decisions: %lld, Propagations: %lld, Conflicts: %lld, Restarts: %lld, Learned: %lld\n",
+           stats->decisions, stats->propagations, stats->conflicts, stats->restarts,
+           stats->learned_clauses - stats->deleted_clauses);
+    fflush(stdout);
+}
+
+void print_solver_stats(const SolverStats* stats)
+{
+    printf("Statistics: Decisions: %lld, Propagations: %lld, Conflicts: %lld, Restarts: %lld\n",
+           stats->decisions, stats->propagations, stats->conflicts, stats->restarts);
+    printf("            Learned: %lld (avg %.1f literals), Deleted: %lld, Max Level: %d\n",
+           stats->learned_clauses,
+           stats->learned_clauses > 0 ? (double)stats->learned_literals / stats->learned_clauses : 0.0,
+           stats->deleted_clauses, stats->max_level);
+    long long derived = stats->learned_literals + stats->minimized_literals;
+    if (stats->minimized_literals)
+        printf("            Minimized: %lld literals (%.1f%% of derived, %.2f per learned clause)\n",
+               stats->minimized_literals, 100.0 * stats->minimized_literals / derived,
+               (double)stats->minimized_literals / stats->learned_clauses);
+    if (stats->vivified_clauses)
+        printf("            Vivified: %lld learned clauses, %.2f literals removed per clause\n", stats->vivified_clauses,
+               (double)stats->inprocess[INPROCESS_VIVIFY].literals / stats->vivified_clauses);
+    if (stats->shared_exported || stats->shared_imported || stats->shared_dropped || stats->shared_missed)
+        printf("            Shared: Exported: %lld, Imported: %lld, Dropped: %lld, Missed: %lld\n",
+               stats->shared_exported, stats->shared_imported, stats->shared_dropped, stats->shared_missed);
+    for (int t = 0; t < INPROCESS_COUNT; t++) {
+        const InprocessStats* is = &stats->inprocess[t];
+        if (is->calls == 0) continue;
+        printf("            %-11s %lld rounds, %.2f s, %lld clauses, %lld literals, %lld variables removed\n",
+               inprocess_names[t], is->calls, is->seconds, is->clauses, is->literals, is->variables);
+    }
+}
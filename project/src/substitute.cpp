@@ -0,0 +1,51 @@
+#include "simplifier.h"
+#include "equivalence.h"
+
+// =========== 等价文字替换 ===========
+// 二元子句的蕴含图里找出等价类(equivalence.cpp), 每个类只留代表文字:
+// 其它变量在所有子句里换成代表, 然后从公式里去掉. 重建栈里记 (v -r) 和 (-v r),
+// 补模型时 v 取 r 的值. 换掉以后重复文字, 重言式(原来连成环的那些二元子句)由 simp_add_clause 处理
+
+void simp_substitute(Simplifier* s)
+{
+    Vec<Literal> binaries;
+    for (int i = 0; i < s->clauses.size(); i++) {
+        const SimpClause& c = s->clauses[i];
+        if (c.deleted || c.size != 2) continue;
+        binaries.push(simp_lits(s, i)[0]);
+        binaries.push(simp_lits(s, i)[1]);
+    }
+    if (binaries.size() == 0) return;
+    Vec<Literal> repr;
+    if (!find_equivalences(s->num_vars, binaries, repr)) {
+        s->ok = FALSE;
+        return;
+    }
+
+    Vec<int> crefs;
+    Vec<Literal> lits;
+    for (Variable v = 1; v <= s->num_vars && s->ok; v++) {
+        Literal r = repr[v];
+        if (r == v || s->eliminated[v] || s->val[v] != UNASSIGNED) continue;
+        for (int side = 0; side < 2; side++) {
+            s->occurs[lit_index(side ? -v : v)].copy_to(crefs);
+            for (int i = 0; i < crefs.size() && s->ok; i++) {
+                const Literal* p = simp_lits(s, crefs[i]);
+                lits.clear();
+                for (int k = 0; k < s->clauses[crefs[i]].size; k++) {
+                    Literal l = p[k];
+                    if (lit_var(l) == v) l = l > 0 ? r : -r;
+                    lits.push(l);
+                }
+                simp_remove_clause(s, crefs[i]);
+                simp_add_clause(s, lits.data(), lits.size());
+            }
+        }
+        // 两项的见证文字分别是 v 和 -v, 补模型时哪个不满足就把 v 改成和 r 一样
+        Literal entry[6] = { v, -r, 2, -v, r, 2 };
+        for (int k = 0; k < 6; k++) s->recon->push(entry[k]);
+        s->eliminated[v] = 1;
+        s->stats->substituted++;
+    }
+    simp_propagate(s);
+}
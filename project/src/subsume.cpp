@@ -0,0 +1,83 @@
+#include "simplifier.h"
+
+// =========== 包含和自包含resolution ===========
+// 后向检查: 对每个子句C, 只看C里出现次数最少的变量的两张出现表, 被C包含的子句D删掉;
+// C和D只差一个文字相反(C里有l, D里有-l, 其余都在D里)时, C和D的resolvent包含D,
+// D去掉-l就行. 签名按变量算, 两种情况都能先用 sig(C) & ~sig(D) 筛掉
+
+typedef enum {
+    SUBSUME_NONE,
+    SUBSUME_ALL,            // C包含D
+    SUBSUME_STRENGTHEN      // D可以去掉 -flip
+} SubsumeResult;
+
+// 调用前C的文字已经标记在 s->mark 上
+static SubsumeResult subset_check(Simplifier* s, int c_size, int d, Literal* flip)
+{
+    const Literal* p = simp_lits(s, d);
+    int n = s->clauses[d].size;
+    int same = 0;
+    *flip = 0;
+    for (int k = 0; k < n; k++) {
+        if (s->mark[lit_index(p[k])]) same++;
+        else if (s->mark[lit_index(-p[k])]) {
+            if (*flip) return SUBSUME_NONE;
+            *flip = -p[k];
+        }
+    }
+    if (same == c_size) return SUBSUME_ALL;
+    if (*flip && same == c_size - 1) return SUBSUME_STRENGTHEN;
+    return SUBSUME_NONE;
+}
+
+void simp_subsume(Simplifier* s, const PreprocessOptions* options)
+{
+    Vec<int> queue;
+    Vec<int> candidates;
+    for (int i = 0; i < s->clauses.size(); i++)
+        if (!s->clauses[i].deleted) queue.push(i);
+
+    long long budget = options->subsume_budget;
+    for (int qi = 0; qi < queue.size() && s->ok && budget > 0; qi++) {
+        int c = queue[qi];
+        if (s->clauses[c].deleted) continue;
+        // 子句里的文字在这一轮里不会搬家: 缩短只在原地挪, 也不加新子句
+        const Literal* p = simp_lits(s, c);
+        int size = s->clauses[c].size;
+        unsigned long long sig = s->clauses[c].sig;
+        Variable best = lit_var(p[0]);
+        int best_occ = s->occurs[lit_index(best)].size() + s->occurs[lit_index(-best)].size();
+        for (int k = 1; k < size; k++) {
+            Variable v = lit_var(p[k]);
+            int occ = s->occurs[lit_index(v)].size() + s->occurs[lit_index(-v)].size();
+            if (occ < best_occ) {
+                best = v;
+                best_occ = occ;
+            }
+        }
+
+        for (int k = 0; k < size; k++) s->mark[lit_index(p[k])] = 1;
+        for (int side = 0; side < 2; side++) {
+            s->occurs[lit_index(side ? -best : best)].copy_to(candidates);
+            for (int i = 0; i < candidates.size(); i++) {
+                int d = candidates[i];
+                const SimpClause& dc = s->clauses[d];
+                if (d == c || dc.deleted || dc.size < size || (sig & ~dc.sig)) continue;
+                budget -= dc.size;
+                Literal flip;
+                SubsumeResult r = subset_check(s, size, d, &flip);
+                if (r == SUBSUME_ALL) {
+                    simp_remove_clause(s, d);
+                    s->stats->subsumed++;
+                } else if (r == SUBSUME_STRENGTHEN) {
+                    simp_strengthen(s, d, -flip);
+                    s->stats->strengthened++;
+                    // 缩短以后可能包含别的子句
+                    if (!s->clauses[d].deleted) queue.push(d);
+                }
+            }
+        }
+        for (int k = 0; k < size; k++) s->mark[lit_index(p[k])] = 0;
+        simp_propagate(s);
+    }
+}
@@ -1,5 +1,6 @@
 #include "sudoku.h"
 #include "sat_solver.h"
+#include "libsat.h"
 #include "fileop.h"
 
 // 初始化数独网格
@@ -89,33 +90,90 @@ void generate_full_sudoku(SudokuGrid* sudoku) {
     solve_sudoku_backtrack(sudoku);
 }
 
+// 题目是否只有 solution 这一个解
+// 数独规则已经在 solver 里了; 提示数作为假设, "至少一个空格和原解不同"用激活文字act挂上去,
+// 检查完加单元子句 -act 把它永久关掉, 所以同一个求解器可以一直复用, 学到的子句也留着
+static int has_unique_solution(SatSolver* solver, const SudokuGrid* puzzle,
+                               const int solution[SUDOKU_SIZE][SUDOKU_SIZE], Variable act)
+{
+    Literal differ[SUDOKU_CELLS + 1];
+    Literal assumptions[SUDOKU_CELLS + 1];
+    int differ_size = 0, assumption_count = 0;
+
+    differ[differ_size++] = -act;
+    for (int row = 0; row < SUDOKU_SIZE; row++) {
+        for (int col = 0; col < SUDOKU_SIZE; col++) {
+            if (puzzle->grid[row][col] != 0)
+                assumptions[assumption_count++] = get_variable_number(row, col, puzzle->grid[row][col]);
+            else
+                differ[differ_size++] = -get_variable_number(row, col, solution[row][col]);
+        }
+    }
+    assumptions[assumption_count++] = act;
+
+    sat_add_clause(solver, differ, differ_size);
+    SatResult result = sat_solve_assuming(solver, assumptions, assumption_count);
+    Literal off = -act;
+    sat_add_clause(solver, &off, 1);
+
+    // UNKNOWN 按不唯一处理, 宁可少挖一个洞
+    return result == UNSAT;
+}
+
 // 挖洞法创建数独题目
+// 按随机顺序每个格子试一次, 挖掉之后解不唯一就填回去
 void create_puzzle_by_digging(SudokuGrid* sudoku, int holes_count) {
     if (holes_count > SUDOKU_CELLS) holes_count = SUDOKU_CELLS - 17;  // 至少保留17个格子
-    
+
+    int solution[SUDOKU_SIZE][SUDOKU_SIZE];
+    memcpy(solution, sudoku->grid, sizeof(solution));
+
+    // 只放数独规则的增量求解器, 所有唯一性检查共用
+    CNF rules;
+    init_cnf(&rules);
+    add_sudoku_constraints(&rules);
+    SatSolver* solver = sat_solver_new(NULL);
+    if (!solver) {
+        free_cnf(&rules);
+        return;
+    }
+    sat_add_cnf(solver, &rules);
+    free_cnf(&rules);
+    Variable next_act = SUDOKU_CELLS * SUDOKU_SIZE + 1;  // 激活变量接在格子变量后面
+
+    int order[SUDOKU_CELLS];
+    for (int i = 0; i < SUDOKU_CELLS; i++) order[i] = i;
+    for (int i = SUDOKU_CELLS - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
     int dug_holes = 0;
-    while (dug_holes < holes_count) {
-        int row = rand() % SUDOKU_SIZE;
-        int col = rand() % SUDOKU_SIZE;
-        
-        if (sudoku->grid[row][col] != 0) {
-            // 临时挖掉这个格子
-            int original_value = sudoku->grid[row][col];
-            sudoku->grid[row][col] = 0;
-            sudoku->filled_cells--;
-            
-            // 检查是否仍有唯一解（简化版检查）
-            SudokuGrid test_sudoku = *sudoku;
-            if (solve_sudoku_backtrack(&test_sudoku)) {
-                // 有解，保持挖掉的状态
-                dug_holes++;
-            } else {
-                // 无解，恢复原值
-                sudoku->grid[row][col] = original_value;
-                sudoku->filled_cells++;
-            }
+    for (int i = 0; i < SUDOKU_CELLS && dug_holes < holes_count; i++) {
+        int row = order[i] / SUDOKU_SIZE;
+        int col = order[i] % SUDOKU_SIZE;
+        if (sudoku->grid[row][col] == 0) continue;
+
+        // 临时挖掉这个格子
+        int original_value = sudoku->grid[row][col];
+        sudoku->grid[row][col] = 0;
+        sudoku->filled_cells--;
+
+        if (has_unique_solution(solver, sudoku, solution, next_act++)) {
+            // 仍然唯一，保持挖掉的状态
+            dug_holes++;
+        } else {
+            // 多解，恢复原值
+            sudoku->grid[row][col] = original_value;
+            sudoku->filled_cells++;
         }
     }
+
+    if (dug_holes < holes_count)
+        printf("Only %d holes can be dug while keeping a unique solution\n", dug_holes);
+    sat_solver_delete(solver);
 }
 
 // 打印数独网格
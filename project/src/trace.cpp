@@ -0,0 +1,127 @@
+#include "trace.h"
+#include <stdio.h>
+
+#ifdef SAT_TRACE
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// =========== trace写入状态 ===========
+
+static FILE* trace_file = NULL;
+static std::atomic<int> trace_on(0);
+static std::mutex trace_mutex;          // 并行模式下多个线程会同时写
+static int first_event = 1;             // 控制逗号
+static std::atomic<int> next_tid(0);
+static std::chrono::steady_clock::time_point trace_epoch;
+
+// 每个线程一条轨道
+static int current_tid(void)
+{
+    static thread_local int tid = -1;
+    if (tid < 0) tid = next_tid++;
+    return tid;
+}
+
+static void write_separator(void)
+{
+    if (!first_event) fputs(",\n", trace_file);
+    first_event = 0;
+}
+
+int trace_open(const char* filename)
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (trace_file) return 1;
+    trace_file = fopen(filename, "w");
+    if (!trace_file) {
+        fprintf(stderr, "Failed to open trace file: %s\n", filename);
+        return 0;
+    }
+    trace_epoch = std::chrono::steady_clock::now();
+    first_event = 1;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", trace_file);
+    trace_on = 1;
+    return 1;
+}
+
+void trace_close(void)
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return;
+    trace_on = 0;
+    fputs("\n]}\n", trace_file);
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+int trace_active(void)
+{
+    return trace_on.load(std::memory_order_relaxed);
+}
+
+long long trace_now_us(void)
+{
+    return (long long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+void trace_complete(const char* name, long long start_us, long long end_us)
+{
+    int tid = current_tid();
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return;
+    write_separator();
+    fprintf(trace_file, "{\"name\":\"%s\",\"cat\":\"sat\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d}",
+            name, start_us, end_us - start_us, tid);
+}
+
+void trace_counter(const char* name, double value)
+{
+    long long ts = trace_now_us();
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return;
+    write_separator();
+    fprintf(trace_file, "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%lld,\"pid\":1,\"args\":{\"value\":%.0f}}",
+            name, ts, value);
+}
+
+void trace_instant(const char* name)
+{
+    long long ts = trace_now_us();
+    int tid = current_tid();
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return;
+    write_separator();
+    fprintf(trace_file, "{\"name\":\"%s\",\"cat\":\"sat\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":%d}",
+            name, ts, tid);
+}
+
+void trace_thread_name(const char* name, int index)
+{
+    int tid = current_tid();
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return;
+    write_separator();
+    fprintf(trace_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+            tid, name, index);
+}
+
+#else
+
+// 没有编译trace: 接口保留, 什么都不做
+int trace_open(const char* filename)
+{
+    fprintf(stderr, "Tracing is not compiled in (configure with -DSAT_ENABLE_TRACE=ON), ignoring %s\n", filename);
+    return 0;
+}
+
+void trace_close(void) {}
+int trace_active(void) { return 0; }
+long long trace_now_us(void) { return 0; }
+void trace_complete(const char*, long long, long long) {}
+void trace_counter(const char*, double) {}
+void trace_instant(const char*) {}
+void trace_thread_name(const char*, int) {}
+
+#endif // SAT_TRACE
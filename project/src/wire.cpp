@@ -0,0 +1,133 @@
+#include "wire.h"
+#include <errno.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// =========== 文件描述符通道 ===========
+
+#ifdef __linux__
+static int fd_read(void* ctx, void* buf, size_t n)
+{
+    int fd = ((WireFds*)ctx)->in_fd;
+    char* p = (char*)buf;
+    while (n > 0) {
+        ssize_t got = read(fd, p, n);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return FALSE;
+        p += got;
+        n -= (size_t)got;
+    }
+    return TRUE;
+}
+
+static int fd_write(void* ctx, const void* buf, size_t n)
+{
+    int fd = ((WireFds*)ctx)->out_fd;
+    const char* p = (const char*)buf;
+    while (n > 0) {
+        // 对方退出以后再写socket会收到SIGPIPE, MSG_NOSIGNAL 让它返回错误; 管道只能用write
+        ssize_t put = send(fd, p, n, MSG_NOSIGNAL);
+        if (put < 0 && errno == ENOTSOCK) put = write(fd, p, n);
+        if (put < 0 && errno == EINTR) continue;
+        if (put <= 0) return FALSE;
+        p += put;
+        n -= (size_t)put;
+    }
+    return TRUE;
+}
+#else
+static int fd_read(void*, void*, size_t) { return FALSE; }
+static int fd_write(void*, const void*, size_t) { return FALSE; }
+#endif
+
+void wire_fd_channel(WireChannel* channel, WireFds* fds)
+{
+    channel->read = fd_read;
+    channel->write = fd_write;
+    channel->ctx = fds;
+    channel->bytes_in = 0;
+    channel->bytes_out = 0;
+}
+
+// =========== 编解码 ===========
+
+void wire_begin(WireMessage* msg, int type)
+{
+    msg->type = type;
+    msg->words.clear();
+    msg->pos = 0;
+}
+
+void wire_put(WireMessage* msg, int x)
+{
+    msg->words.push(x);
+}
+
+void wire_put64(WireMessage* msg, long long x)
+{
+    unsigned long long u = (unsigned long long)x;
+    wire_put(msg, (int)(unsigned int)(u & 0xffffffffu));
+    wire_put(msg, (int)(unsigned int)(u >> 32));
+}
+
+int wire_get(WireMessage* msg, int* x)
+{
+    if (msg->pos >= msg->words.size()) return FALSE;
+    *x = msg->words[msg->pos++];
+    return TRUE;
+}
+
+int wire_get64(WireMessage* msg, long long* x)
+{
+    int lo, hi;
+    if (!wire_get(msg, &lo) || !wire_get(msg, &hi)) return FALSE;
+    *x = (long long)(((unsigned long long)(unsigned int)hi << 32) | (unsigned int)lo);
+    return TRUE;
+}
+
+static void store_u32(unsigned char* p, unsigned int x)
+{
+    p[0] = (unsigned char)x;
+    p[1] = (unsigned char)(x >> 8);
+    p[2] = (unsigned char)(x >> 16);
+    p[3] = (unsigned char)(x >> 24);
+}
+
+static unsigned int load_u32(const unsigned char* p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+int wire_send(WireChannel* channel, const WireMessage* msg)
+{
+    int n = msg->words.size();
+    Vec<unsigned char> buf;
+    buf.grow_to(8 + 4 * n, 0);
+    store_u32(buf.data(), (unsigned int)msg->type);
+    store_u32(buf.data() + 4, (unsigned int)(4 * n));
+    for (int i = 0; i < n; i++) store_u32(buf.data() + 8 + 4 * i, (unsigned int)msg->words[i]);
+    if (!channel->write(channel->ctx, buf.data(), (size_t)buf.size())) return FALSE;
+    channel->bytes_out += buf.size();
+    return TRUE;
+}
+
+int wire_recv(WireChannel* channel, WireMessage* msg)
+{
+    unsigned char head[8];
+    if (!channel->read(channel->ctx, head, sizeof(head))) return FALSE;
+    unsigned int type = load_u32(head);
+    unsigned int bytes = load_u32(head + 4);
+    if (type < WIRE_HELLO || type > WIRE_QUIT || bytes % 4 != 0 || bytes > WIRE_MAX_PAYLOAD) return FALSE;
+
+    Vec<unsigned char> buf;
+    buf.grow_to((int)bytes, 0);
+    if (bytes > 0 && !channel->read(channel->ctx, buf.data(), bytes)) return FALSE;
+    channel->bytes_in += 8 + bytes;
+
+    wire_begin(msg, (int)type);
+    msg->words.reserve((int)(bytes / 4));
+    for (unsigned int i = 0; i < bytes / 4; i++) msg->words.push((int)load_u32(buf.data() + 4 * i));
+    return TRUE;
+}